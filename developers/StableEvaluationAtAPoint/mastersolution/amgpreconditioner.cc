@@ -0,0 +1,173 @@
+/**
+ * @file amgpreconditioner.cc
+ * @brief NPDE homework StableEvaluationAtAPoint
+ * @author Amélie Loher, Erick Schulz & Philippe Peter
+ * @date 29.11.2021
+ * @copyright Developed at ETH Zurich
+ */
+
+#include "amgpreconditioner.h"
+
+#include <Eigen/Core>
+#include <Eigen/SparseCholesky>
+#include <Eigen/SparseCore>
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+#include "gaussseidel.h"
+
+namespace StableEvaluationAtAPoint {
+
+namespace {
+
+using RowMatrix = Eigen::SparseMatrix<double, Eigen::RowMajor>;
+
+}  // namespace
+
+RowMatrix AMGPreconditioner::Prolongation(const RowMatrix &A) {
+  const Eigen::Index n = A.rows();
+  const Eigen::VectorXd diag = A.diagonal();
+
+  // Strong couplings of every unknown
+  std::vector<std::vector<Eigen::Index>> strong(n);
+  for (Eigen::Index i = 0; i < n; ++i) {
+    for (RowMatrix::InnerIterator it(A, i); it; ++it) {
+      const Eigen::Index j = it.col();
+      if (j != i && std::abs(it.value()) >=
+                        StrengthThreshold() *
+                            std::sqrt(std::abs(diag[i] * diag[j]))) {
+        strong[i].push_back(j);
+      }
+    }
+  }
+
+  // Greedy aggregation, -1 marks unknowns not (yet) aggregated
+  std::vector<Eigen::Index> aggregate(n, -1);
+  Eigen::Index N_agg = 0;
+  // 1. Unknowns whose strong neighbours are all free form an aggregate with
+  // them
+  for (Eigen::Index i = 0; i < n; ++i) {
+    if (aggregate[i] >= 0 || strong[i].empty()) {
+      continue;
+    }
+    const bool free = std::all_of(
+        strong[i].begin(), strong[i].end(),
+        [&aggregate](Eigen::Index j) { return aggregate[j] < 0; });
+    if (free) {
+      aggregate[i] = N_agg;
+      for (Eigen::Index j : strong[i]) {
+        aggregate[j] = N_agg;
+      }
+      ++N_agg;
+    }
+  }
+  // 2. Remaining unknowns join an aggregate of a strong neighbour from step 1
+  std::vector<Eigen::Index> aggregate_1 = aggregate;
+  for (Eigen::Index i = 0; i < n; ++i) {
+    if (aggregate[i] >= 0) {
+      continue;
+    }
+    for (Eigen::Index j : strong[i]) {
+      if (aggregate_1[j] >= 0) {
+        aggregate[i] = aggregate_1[j];
+        break;
+      }
+    }
+  }
+  // 3. Unknowns still left form aggregates with their free strong neighbours
+  for (Eigen::Index i = 0; i < n; ++i) {
+    if (aggregate[i] >= 0 || strong[i].empty()) {
+      continue;
+    }
+    aggregate[i] = N_agg;
+    for (Eigen::Index j : strong[i]) {
+      if (aggregate[j] < 0) {
+        aggregate[j] = N_agg;
+      }
+    }
+    ++N_agg;
+  }
+  if (N_agg == 0 || N_agg >= n) {
+    return RowMatrix();
+  }
+
+  // Tentative prolongation with orthonormal columns representing constants
+  std::vector<Eigen::Index> agg_size(N_agg, 0);
+  for (Eigen::Index i = 0; i < n; ++i) {
+    if (aggregate[i] >= 0) {
+      ++agg_size[aggregate[i]];
+    }
+  }
+  std::vector<Eigen::Triplet<double>> triplets;
+  for (Eigen::Index i = 0; i < n; ++i) {
+    if (aggregate[i] >= 0) {
+      triplets.emplace_back(i, aggregate[i],
+                            1.0 / std::sqrt(double(agg_size[aggregate[i]])));
+    }
+  }
+  RowMatrix T(n, N_agg);
+  T.setFromTriplets(triplets.begin(), triplets.end());
+
+  // Jacobi smoothing P = (I - omega D^{-1} A) T with omega = 4 / (3 rho),
+  // where rho >= rho(D^{-1} A) is the Gershgorin bound
+  Eigen::VectorXd inv_diag(n);
+  double rho = 0.0;
+  for (Eigen::Index i = 0; i < n; ++i) {
+    inv_diag[i] = diag[i] != 0.0 ? 1.0 / diag[i] : 0.0;
+    double row_sum = 0.0;
+    for (RowMatrix::InnerIterator it(A, i); it; ++it) {
+      row_sum += std::abs(it.value());
+    }
+    rho = std::max(rho, row_sum * std::abs(inv_diag[i]));
+  }
+  const double omega = 4.0 / (3.0 * rho);
+  const RowMatrix AT = A * T;
+  const RowMatrix DAT = (omega * inv_diag).asDiagonal() * AT;
+  RowMatrix P = T - DAT;
+  P.prune(0.0);
+  return P;
+}
+
+void AMGPreconditioner::Setup(RowMatrix A) {
+  levels_.clear();
+  levels_.push_back({std::move(A), RowMatrix(), RowMatrix()});
+  while (levels_.back().A.rows() > MaxCoarseSize()) {
+    Level &fine = levels_.back();
+    fine.P = Prolongation(fine.A);
+    if (fine.P.cols() == 0) {
+      break;
+    }
+    fine.R = fine.P.transpose();
+    RowMatrix A_coarse = fine.R * fine.A * fine.P;
+    A_coarse.prune(0.0);
+    levels_.push_back({std::move(A_coarse), RowMatrix(), RowMatrix()});
+  }
+  coarse_solver_.compute(Eigen::SparseMatrix<double>(levels_.back().A));
+  info_ = coarse_solver_.info();
+}
+
+void AMGPreconditioner::VCycle(unsigned int l, const Eigen::VectorXd &b,
+                               Eigen::VectorXd &x) const {
+  const Level &level = levels_[l];
+  if (l + 1 == levels_.size()) {
+    x = coarse_solver_.solve(b);
+    return;
+  }
+  x.setZero(b.size());
+  GaussSeidel(level.A, b, x, true);
+  const Eigen::VectorXd r_coarse = level.R * (b - level.A * x);
+  Eigen::VectorXd x_coarse;
+  VCycle(l + 1, r_coarse, x_coarse);
+  x += level.P * x_coarse;
+  GaussSeidel(level.A, b, x, false);
+}
+
+Eigen::VectorXd AMGPreconditioner::solve(const Eigen::VectorXd &b) const {
+  Eigen::VectorXd x;
+  VCycle(0, b, x);
+  return x;
+}
+
+}  // namespace StableEvaluationAtAPoint
@@ -0,0 +1,102 @@
+#ifndef AMG_PRECONDITIONER_H
+#define AMG_PRECONDITIONER_H
+
+/**
+ * @file amgpreconditioner.h
+ * @brief NPDE homework StableEvaluationAtAPoint
+ * @author Amélie Loher, Erick Schulz & Philippe Peter
+ * @date 29.11.2021
+ * @copyright Developed at ETH Zurich
+ */
+
+#include <Eigen/Core>
+#include <Eigen/SparseCholesky>
+#include <Eigen/SparseCore>
+#include <vector>
+
+namespace StableEvaluationAtAPoint {
+
+/** @brief Smoothed aggregation algebraic multigrid preconditioner for
+ * symmetric positive definite M-matrices like the P1 Laplacian
+ *
+ * Setup: the strongly coupled unknowns are grouped into aggregates, which
+ * are the unknowns of the next coarser level. The piecewise constant
+ * tentative prolongation is smoothed by one damped Jacobi step, the coarse
+ * matrix is the Galerkin product P^T A P. Unknowns without strong couplings,
+ * e.g. the rows of eliminated Dirichlet dofs, are left to the smoother. This
+ * is repeated until the system is small enough for a sparse Cholesky
+ * decomposition.
+ * Application: one V-cycle with forward Gauss-Seidel pre- and backward
+ * Gauss-Seidel post-smoothing, which is a symmetric positive definite
+ * operator as required by the CG method. The resulting iteration counts do
+ * not grow under mesh refinement.
+ *
+ * The class provides the interface of an Eigen preconditioner, e.g. for
+ * Eigen::ConjugateGradient.
+ */
+class AMGPreconditioner {
+ public:
+  using Scalar = double;
+  using StorageIndex = int;
+  enum {
+    ColsAtCompileTime = Eigen::Dynamic,
+    MaxColsAtCompileTime = Eigen::Dynamic
+  };
+
+  AMGPreconditioner() = default;
+
+  template <typename MATTYPE>
+  AMGPreconditioner &analyzePattern(const MATTYPE & /*A*/) {
+    return *this;
+  }
+  template <typename MATTYPE>
+  AMGPreconditioner &factorize(const MATTYPE &A) {
+    Setup(Eigen::SparseMatrix<double, Eigen::RowMajor>(A));
+    return *this;
+  }
+  template <typename MATTYPE>
+  AMGPreconditioner &compute(const MATTYPE &A) {
+    return factorize(A);
+  }
+
+  /** @brief Applies one V-cycle with initial guess 0 to b */
+  Eigen::VectorXd solve(const Eigen::VectorXd &b) const;
+
+  Eigen::ComputationInfo info() const { return info_; }
+  Eigen::Index rows() const {
+    return levels_.empty() ? 0 : levels_[0].A.rows();
+  }
+  Eigen::Index cols() const { return rows(); }
+  /** @brief Number of levels including the coarsest one */
+  unsigned int NumLevels() const {
+    return static_cast<unsigned int>(levels_.size());
+  }
+
+  // Threshold for strong couplings |a_ij| >= theta sqrt(|a_ii a_jj|)
+  static double StrengthThreshold() { return 0.08; }
+  // Systems of at most this size are solved directly
+  static Eigen::Index MaxCoarseSize() { return 200; }
+
+ private:
+  struct Level {
+    Eigen::SparseMatrix<double, Eigen::RowMajor> A;
+    // Prolongation from the next coarser level and its transpose
+    Eigen::SparseMatrix<double, Eigen::RowMajor> P;
+    Eigen::SparseMatrix<double, Eigen::RowMajor> R;
+  };
+
+  void Setup(Eigen::SparseMatrix<double, Eigen::RowMajor> A);
+  // Smoothed prolongation for A, empty if A cannot be coarsened
+  static Eigen::SparseMatrix<double, Eigen::RowMajor> Prolongation(
+      const Eigen::SparseMatrix<double, Eigen::RowMajor> &A);
+  void VCycle(unsigned int l, const Eigen::VectorXd &b,
+              Eigen::VectorXd &x) const;
+
+  std::vector<Level> levels_;
+  Eigen::SimplicialLDLT<Eigen::SparseMatrix<double>> coarse_solver_;
+  Eigen::ComputationInfo info_ = Eigen::Success;
+};
+
+}  // namespace StableEvaluationAtAPoint
+
+#endif  // AMG_PRECONDITIONER_H
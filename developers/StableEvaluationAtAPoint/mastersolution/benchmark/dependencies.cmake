@@ -0,0 +1,40 @@
+# Dependencies of the mastersolution benchmarks:
+
+# DIR will be provided by the calling file.
+
+set(SOURCES
+  ${DIR}/benchmark/stableevaluationatapoint_benchmark.cc
+  ${DIR}/stableevaluationatapoint.cc
+  ${DIR}/pointlocator.cc
+  ${DIR}/boundaryquadraturecache.cc
+  ${DIR}/boundarytreecode.cc
+  ${DIR}/linearsolver.cc
+  ${DIR}/amgpreconditioner.cc
+  ${DIR}/multigrid.cc
+  ${DIR}/gaussseidel.cc
+  ${DIR}/dirichletsolver.cc
+  ${DIR}/csrassembler.cc
+  ${DIR}/reducedsystem.cc
+  ${DIR}/meshcache.cc
+  ${DIR}/unitsquaremesh.cc
+  ${DIR}/studyoptions.cc
+  ${DIR}/profiler.cc
+  ${DIR}/trianglegeometry.cc
+)
+
+set(LIBRARIES
+  Eigen3::Eigen
+  benchmark::benchmark
+  LF::lf.assemble
+  LF::lf.base
+  LF::lf.fe
+  LF::lf.geometry
+  LF::lf.io
+  LF::lf.mesh
+  LF::lf.mesh.hybrid2d
+  LF::lf.mesh.utils
+  LF::lf.quad
+  LF::lf.refinement
+  LF::lf.uscalfe
+  Threads::Threads
+)
@@ -0,0 +1,245 @@
+/**
+ * @file stableevaluationatapoint_benchmark.cc
+ * @brief NPDE homework StableEvaluationAtAPoint
+ * @author Amélie Loher, Erick Schulz & Philippe Peter
+ * @date 29.11.2021
+ * @copyright Developed at ETH Zurich
+ */
+
+#include <benchmark/benchmark.h>
+#include <lf/mesh/mesh.h>
+#include <lf/quad/quad.h>
+#include <lf/uscalfe/uscalfe.h>
+
+#include <Eigen/Core>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <random>
+
+#include "../boundaryquadraturecache.h"
+#include "../pointlocator.h"
+#include "../stableevaluationatapoint.h"
+#include "../unitsquaremesh.h"
+
+// Every benchmark reports the time per call. Benchmarks over meshes take the
+// resolution n of GenerateUnitSquareMesh() with 2 n^2 cells as argument,
+// report the throughput in cells/s and fit the complexity in the number of
+// cells, so that the runs over n give the scaling curves.
+
+namespace {
+
+using StableEvaluationAtAPoint::GenerateUnitSquareMesh;
+
+// Exact solution of the convergence study in main
+double U(Eigen::Vector2d x) {
+  Eigen::Vector2d one(1.0, 0.0);
+  return std::log((x + one).norm());
+}
+
+std::shared_ptr<lf::uscalfe::FeSpaceLagrangeO1<double>> FeSpace(
+    unsigned int n) {
+  return std::make_shared<lf::uscalfe::FeSpaceLagrangeO1<double>>(
+      GenerateUnitSquareMesh(n));
+}
+
+// Random points in the disk where StablePointEvaluation() applies
+Eigen::Matrix2Xd RandomPoints(Eigen::Index N) {
+  std::mt19937 gen(42);
+  std::uniform_real_distribution<double> dist(0.3, 0.7);
+  Eigen::Matrix2Xd points(2, N);
+  for (Eigen::Index i = 0; i < N; ++i) {
+    points.col(i) << dist(gen), dist(gen);
+  }
+  return points;
+}
+
+// Cells of the mesh as throughput counter and complexity parameter
+void SetCells(benchmark::State &state, std::int64_t cells) {
+  state.counters["cells/s"] =
+      benchmark::Counter(static_cast<double>(cells),
+                         benchmark::Counter::kIsIterationInvariantRate);
+  state.SetComplexityN(cells);
+}
+
+void BM_FundamentalSolution(benchmark::State &state) {
+  StableEvaluationAtAPoint::FundamentalSolution G(Eigen::Vector2d(0.3, 0.4));
+  const Eigen::Matrix2Xd ys = RandomPoints(1024);
+  for (auto _ : state) {
+    for (Eigen::Index i = 0; i < ys.cols(); ++i) {
+      benchmark::DoNotOptimize(G(ys.col(i)));
+      benchmark::DoNotOptimize(G.grad(ys.col(i)));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * ys.cols());
+}
+BENCHMARK(BM_FundamentalSolution);
+
+void BM_Psi(benchmark::State &state) {
+  StableEvaluationAtAPoint::Psi psi(Eigen::Vector2d(0.5, 0.5));
+  // Points in the square, most of them in the transition zone
+  std::mt19937 gen(42);
+  std::uniform_real_distribution<double> dist(0.0, 1.0);
+  Eigen::Matrix2Xd ys(2, 1024);
+  for (Eigen::Index i = 0; i < ys.cols(); ++i) {
+    ys.col(i) << dist(gen), dist(gen);
+  }
+  for (auto _ : state) {
+    for (Eigen::Index i = 0; i < ys.cols(); ++i) {
+      benchmark::DoNotOptimize(psi(ys.col(i)));
+      benchmark::DoNotOptimize(psi.grad(ys.col(i)));
+      benchmark::DoNotOptimize(psi.lapl(ys.col(i)));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * ys.cols());
+}
+BENCHMARK(BM_Psi);
+
+// P_SL - P_DL at one point, the boundary of the n x n mesh has 4 n edges
+void BM_PSLPDL(benchmark::State &state) {
+  const StableEvaluationAtAPoint::BoundaryQuadratureCache cache(
+      GenerateUnitSquareMesh(state.range(0)));
+  const Eigen::Vector2d x(0.3, 0.4);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(StableEvaluationAtAPoint::PSL(cache, U, x) -
+                             StableEvaluationAtAPoint::PDL(cache, U, x));
+  }
+  state.SetItemsProcessed(state.iterations() * 2 * cache.NumPoints());
+  state.SetComplexityN(cache.NumEdges());
+}
+BENCHMARK(BM_PSLPDL)->RangeMultiplier(4)->Range(16, 4096)->Complexity();
+
+// Batched P_SL - P_DL at 1024 points
+void BM_PSLPDLMulti(benchmark::State &state) {
+  const StableEvaluationAtAPoint::BoundaryQuadratureCache cache(
+      GenerateUnitSquareMesh(state.range(0)));
+  const Eigen::Matrix2Xd xs = RandomPoints(1024);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        StableEvaluationAtAPoint::PSLMulti(cache, U, xs, 1) -
+        StableEvaluationAtAPoint::PDLMulti(cache, U, xs, 1));
+  }
+  state.SetItemsProcessed(state.iterations() * 2 * cache.NumPoints() *
+                          xs.cols());
+  state.SetComplexityN(cache.NumEdges());
+}
+BENCHMARK(BM_PSLPDLMulti)->RangeMultiplier(4)->Range(16, 1024)->Complexity();
+
+// P_SL - P_DL on a 200 x 200 grid of points inside the square, summed
+// directly (second argument 0) or by the treecode with tolerance 1e-10
+// (second argument 1). The treecode reports its maximal deviation from the
+// direct sums.
+void BM_PSLPDLTreecode(benchmark::State &state) {
+  const StableEvaluationAtAPoint::BoundaryQuadratureCache cache(
+      GenerateUnitSquareMesh(state.range(0)));
+  const int n = 200;
+  Eigen::Matrix2Xd grid(2, n * n);
+  for (int i = 0; i < n; ++i) {
+    for (int j = 0; j < n; ++j) {
+      grid.col(i * n + j) << (i + 0.5) / n, (j + 0.5) / n;
+    }
+  }
+  const double treecode_tol = state.range(1) == 0 ? 0.0 : 1.0E-10;
+  Eigen::VectorXd vals;
+  for (auto _ : state) {
+    vals = StableEvaluationAtAPoint::PSLMulti(cache, U, grid, 0,
+                                              treecode_tol) -
+           StableEvaluationAtAPoint::PDLMulti(cache, U, grid, 0,
+                                              treecode_tol);
+    benchmark::DoNotOptimize(vals.data());
+  }
+  if (treecode_tol > 0.0) {
+    const Eigen::VectorXd direct =
+        StableEvaluationAtAPoint::PSLMulti(cache, U, grid) -
+        StableEvaluationAtAPoint::PDLMulti(cache, U, grid);
+    state.counters["max_diff"] = (vals - direct).cwiseAbs().maxCoeff();
+  }
+  state.SetItemsProcessed(state.iterations() * grid.cols());
+}
+BENCHMARK(BM_PSLPDLTreecode)
+    ->ArgsProduct({{64, 256, 1024}, {0, 1}})
+    ->Unit(benchmark::kMillisecond);
+
+void BM_Jstar(benchmark::State &state) {
+  const auto fe_space = FeSpace(state.range(0));
+  const Eigen::VectorXd uFE = StableEvaluationAtAPoint::SolveBVP(fe_space, U);
+  const Eigen::Vector2d x(0.3, 0.4);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        StableEvaluationAtAPoint::Jstar(fe_space, uFE, x));
+  }
+  SetCells(state, fe_space->Mesh()->NumEntities(0));
+}
+BENCHMARK(BM_Jstar)->RangeMultiplier(2)->Range(16, 512)->Complexity();
+
+// Jstar at 64 points in one pass
+void BM_JstarMulti(benchmark::State &state) {
+  const auto fe_space = FeSpace(state.range(0));
+  const Eigen::VectorXd uFE = StableEvaluationAtAPoint::SolveBVP(fe_space, U);
+  const Eigen::Matrix2Xd xs = RandomPoints(64);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        StableEvaluationAtAPoint::JstarMulti(fe_space, uFE, xs));
+  }
+  SetCells(state, fe_space->Mesh()->NumEntities(0));
+  state.SetItemsProcessed(state.iterations() * xs.cols());
+}
+BENCHMARK(BM_JstarMulti)->RangeMultiplier(2)->Range(16, 512)->Complexity();
+
+// Search through all cells
+void BM_EvaluateFEFunction(benchmark::State &state) {
+  const auto fe_space = FeSpace(state.range(0));
+  const Eigen::VectorXd uFE = StableEvaluationAtAPoint::SolveBVP(fe_space, U);
+  const Eigen::Vector2d x(0.3, 0.4);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        StableEvaluationAtAPoint::EvaluateFEFunction(fe_space, uFE, x));
+  }
+  SetCells(state, fe_space->Mesh()->NumEntities(0));
+}
+BENCHMARK(BM_EvaluateFEFunction)
+    ->RangeMultiplier(2)
+    ->Range(16, 512)
+    ->Complexity();
+
+// Lookup in a prebuilt PointLocator, 1024 points per call
+void BM_EvaluateFEFunctionLocator(benchmark::State &state) {
+  const auto fe_space = FeSpace(state.range(0));
+  const Eigen::VectorXd uFE = StableEvaluationAtAPoint::SolveBVP(fe_space, U);
+  const StableEvaluationAtAPoint::PointLocator locator(fe_space->Mesh());
+  const Eigen::Matrix2Xd xs = RandomPoints(1024);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(StableEvaluationAtAPoint::EvaluateFEFunction(
+        fe_space, uFE, locator, xs));
+  }
+  state.SetItemsProcessed(state.iterations() * xs.cols());
+  state.SetComplexityN(fe_space->Mesh()->NumEntities(0));
+}
+BENCHMARK(BM_EvaluateFEFunctionLocator)
+    ->RangeMultiplier(2)
+    ->Range(16, 512)
+    ->Complexity();
+
+// Second argument: StableEvaluationAtAPoint::SolverType
+void BM_SolveBVP(benchmark::State &state) {
+  const auto fe_space = FeSpace(state.range(0));
+  const auto solver_type =
+      static_cast<StableEvaluationAtAPoint::SolverType>(state.range(1));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        StableEvaluationAtAPoint::SolveBVP(fe_space, U, solver_type));
+  }
+  SetCells(state, fe_space->Mesh()->NumEntities(0));
+}
+BENCHMARK(BM_SolveBVP)
+    ->ArgsProduct(
+        {benchmark::CreateRange(16, 256, 2),
+         {static_cast<std::int64_t>(
+              StableEvaluationAtAPoint::SolverType::kSparseLU),
+          static_cast<std::int64_t>(
+              StableEvaluationAtAPoint::SolverType::kCGAMG)}})
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,147 @@
+/**
+ * @file boundaryquadraturecache.cc
+ * @brief NPDE homework StableEvaluationAtAPoint
+ * @author Amélie Loher, Erick Schulz & Philippe Peter
+ * @date 29.11.2021
+ * @copyright Developed at ETH Zurich
+ */
+
+#include "boundaryquadraturecache.h"
+
+#include <lf/base/base.h>
+#include <lf/geometry/geometry.h>
+#include <lf/mesh/mesh.h>
+#include <lf/mesh/utils/utils.h>
+#include <lf/quad/quad.h>
+
+#include <Eigen/Core>
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+namespace StableEvaluationAtAPoint {
+
+namespace {
+
+// Distance of the point x to the segment [a, b]
+double DistanceToSegment(const Eigen::Vector2d &x, const Eigen::Vector2d &a,
+                         const Eigen::Vector2d &b) {
+  const Eigen::Vector2d e = b - a;
+  const double t = std::clamp((x - a).dot(e) / e.squaredNorm(), 0.0, 1.0);
+  return (a + t * e - x).norm();
+}
+
+}  // namespace
+
+BoundaryQuadratureCache::BoundaryQuadratureCache(
+    const std::shared_ptr<const lf::mesh::Mesh> &mesh_p,
+    const lf::quad::QuadRule &qr, double near_field_ratio)
+    : near_field_ratio_(near_field_ratio) {
+  LF_ASSERT_MSG(qr.RefEl() == lf::base::RefEl::kSegment(),
+                "Quadrature rule must be defined on the reference segment");
+  ref_points_ = qr.Points().row(0).transpose();
+  ref_weights_ = qr.Weights();
+
+  // Flag edges on the boundary
+  auto bd_flags_edge{lf::mesh::utils::flagEntitiesOnBoundary(mesh_p, 1)};
+
+  // The outer normal of a boundary edge is perpendicular to the edge and
+  // points away from the single cell adjacent to it
+  Eigen::Matrix2Xd edge_normals(2, mesh_p->NumEntities(1));
+  for (const lf::mesh::Entity *cell : mesh_p->Entities(0)) {
+    const Eigen::MatrixXd cell_corners =
+        lf::geometry::Corners(*cell->Geometry());
+    const Eigen::Vector2d center = cell_corners.rowwise().mean();
+    for (const lf::mesh::Entity *e : cell->SubEntities(1)) {
+      if (bd_flags_edge(*e)) {
+        const Eigen::MatrixXd corners = lf::geometry::Corners(*e->Geometry());
+        const Eigen::Vector2d t = corners.col(1) - corners.col(0);
+        Eigen::Vector2d n(t(1), -t(0));
+        n /= n.norm();
+        if (n.dot(corners.col(0) - center) < 0.0) {
+          n = -n;
+        }
+        edge_normals.col(mesh_p->Index(*e)) = n;
+      }
+    }
+  }
+
+  // Gather the data of the boundary edges in the order of the edge indices
+  std::vector<const lf::mesh::Entity *> bd_edges;
+  for (const lf::mesh::Entity *e : mesh_p->Entities(1)) {
+    if (bd_flags_edge(*e)) {
+      bd_edges.push_back(e);
+    }
+  }
+  const Eigen::Index N_bd = bd_edges.size();
+  const Eigen::Index P = PointsPerEdge();
+  corners_.resize(4, N_bd);
+  edge_lengths_.resize(N_bd);
+  points_.resize(2, N_bd * P);
+  weights_.resize(N_bd * P);
+  normals_.resize(2, N_bd * P);
+  for (Eigen::Index k = 0; k < N_bd; ++k) {
+    const lf::geometry::Geometry *geo_ptr = bd_edges[k]->Geometry();
+    LF_ASSERT_MSG(geo_ptr != nullptr, "Missing geometry!");
+    const Eigen::MatrixXd corners = lf::geometry::Corners(*geo_ptr);
+    corners_.block<2, 1>(0, k) = corners.col(0);
+    corners_.block<2, 1>(2, k) = corners.col(1);
+    edge_lengths_[k] = lf::geometry::Volume(*geo_ptr);
+    for (Eigen::Index l = 0; l < P; ++l) {
+      points_.col(k * P + l) =
+          corners.col(0) + ref_points_[l] * (corners.col(1) - corners.col(0));
+      weights_[k * P + l] = ref_weights_[l] * edge_lengths_[k];
+      normals_.col(k * P + l) = edge_normals.col(mesh_p->Index(*bd_edges[k]));
+    }
+  }
+}
+
+bool BoundaryQuadratureCache::NearFieldRule(Eigen::Index k,
+                                            const Eigen::Vector2d &x,
+                                            Eigen::Matrix2Xd &points,
+                                            Eigen::VectorXd &weights,
+                                            unsigned int max_depth) const {
+  const Eigen::Vector2d a = corners_.block<2, 1>(0, k);
+  const Eigen::Vector2d b = corners_.block<2, 1>(2, k);
+  if (DistanceToSegment(x, a, b) >= near_field_ratio_ * edge_lengths_[k]) {
+    return false;
+  }
+
+  // Bisect the parameter interval [0, 1] of the edge until every part
+  // [t0, t1] is at most as long as its distance to x
+  struct Part {
+    double t0, t1;
+    unsigned int depth;
+  };
+  std::vector<Part> parts;
+  std::vector<Part> stack{{0.0, 1.0, 0}};
+  while (!stack.empty()) {
+    const Part part = stack.back();
+    stack.pop_back();
+    const double dist =
+        DistanceToSegment(x, a + part.t0 * (b - a), a + part.t1 * (b - a));
+    if (part.depth >= max_depth ||
+        (part.t1 - part.t0) * edge_lengths_[k] <= dist) {
+      parts.push_back(part);
+    } else {
+      const double t_mid = 0.5 * (part.t0 + part.t1);
+      stack.push_back({part.t0, t_mid, part.depth + 1});
+      stack.push_back({t_mid, part.t1, part.depth + 1});
+    }
+  }
+
+  const Eigen::Index P = PointsPerEdge();
+  points.resize(2, parts.size() * P);
+  weights.resize(parts.size() * P);
+  Eigen::Index q = 0;
+  for (const Part &part : parts) {
+    const double h = part.t1 - part.t0;
+    for (Eigen::Index l = 0; l < P; ++l, ++q) {
+      points.col(q) = a + (part.t0 + h * ref_points_[l]) * (b - a);
+      weights[q] = ref_weights_[l] * h * edge_lengths_[k];
+    }
+  }
+  return true;
+}
+
+}  // namespace StableEvaluationAtAPoint
@@ -0,0 +1,86 @@
+#ifndef BOUNDARY_QUADRATURE_CACHE_H
+#define BOUNDARY_QUADRATURE_CACHE_H
+
+/**
+ * @file boundaryquadraturecache.h
+ * @brief NPDE homework StableEvaluationAtAPoint
+ * @author Amélie Loher, Erick Schulz & Philippe Peter
+ * @date 29.11.2021
+ * @copyright Developed at ETH Zurich
+ */
+
+#include <lf/base/base.h>
+#include <lf/mesh/mesh.h>
+#include <lf/quad/quad.h>
+
+#include <Eigen/Core>
+#include <memory>
+
+namespace StableEvaluationAtAPoint {
+
+/** @brief Quadrature data on the boundary edges of a mesh needed by the
+ * boundary potentials P_SL and P_DL.
+ *
+ * A quadrature rule on the reference segment is mapped to every boundary
+ * edge. Points, weights and outer unit normals are computed once and stored
+ * in contiguous arrays (one column/entry per quadrature point, the points of
+ * edge k at the positions k * PointsPerEdge(), ..., (k + 1) * PointsPerEdge()
+ * - 1, edges ordered by edge index), so that repeated evaluations of the
+ * potentials neither scan all edges of the mesh nor call the Geometry
+ * interface. The default one-point rule is the midpoint rule.
+ */
+class BoundaryQuadratureCache {
+ public:
+  /** @brief Extracts the boundary edges of a mesh of straight triangles
+   * @param qr quadrature rule on the reference segment, e.g. the Gauss rule
+   * with n points obtained from
+   * lf::quad::make_QuadRule(lf::base::RefEl::kSegment(), 2 * n - 1)
+   * @param near_field_ratio edges closer to an evaluation point than this
+   * ratio times their length are treated by NearFieldRule(), 0 disables it.
+   * With the default ratio PSL(cache, ...) and PDL(cache, ...) differ from
+   * PSL(mesh_p, ...) and PDL(mesh_p, ...) at points near the boundary, which
+   * on coarse meshes includes interior points; pass 0 to match them.
+   */
+  explicit BoundaryQuadratureCache(
+      const std::shared_ptr<const lf::mesh::Mesh> &mesh_p,
+      const lf::quad::QuadRule &qr =
+          lf::quad::make_QuadRule(lf::base::RefEl::kSegment(), 1),
+      double near_field_ratio = 1.0);
+
+  Eigen::Index NumEdges() const { return edge_lengths_.size(); }
+  Eigen::Index PointsPerEdge() const { return ref_weights_.size(); }
+  Eigen::Index NumPoints() const { return weights_.size(); }
+  const Eigen::Matrix2Xd &Points() const { return points_; }
+  const Eigen::VectorXd &Weights() const { return weights_; }
+  const Eigen::Matrix2Xd &Normals() const { return normals_; }
+
+  /** @brief Quadrature rule on edge k adapted to a point x close to it
+   *
+   * The integrands of P_SL and P_DL are nearly singular on edges whose
+   * distance to x is small compared to their length, i.e. below the
+   * near_field_ratio passed to the constructor. On such an edge the
+   * rule is applied on a partition refined geometrically towards x, such
+   * that every part is at most as long as its distance to x.
+   * @return false if x is far from edge k, in which case the regular points
+   * of the edge are accurate and points, weights are left unchanged
+   */
+  bool NearFieldRule(Eigen::Index k, const Eigen::Vector2d &x,
+                     Eigen::Matrix2Xd &points, Eigen::VectorXd &weights,
+                     unsigned int max_depth = 30) const;
+
+ private:
+  Eigen::Matrix2Xd points_;
+  Eigen::VectorXd weights_;
+  Eigen::Matrix2Xd normals_;
+  // Endpoints of the edges, start in rows 0,1, end in rows 2,3
+  Eigen::Matrix<double, 4, Eigen::Dynamic> corners_;
+  Eigen::VectorXd edge_lengths_;
+  // The rule on the reference segment [0, 1]
+  Eigen::VectorXd ref_points_;
+  Eigen::VectorXd ref_weights_;
+  double near_field_ratio_;
+};
+
+}  // namespace StableEvaluationAtAPoint
+
+#endif  // BOUNDARY_QUADRATURE_CACHE_H
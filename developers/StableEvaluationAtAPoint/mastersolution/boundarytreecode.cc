@@ -0,0 +1,202 @@
+/**
+ * @file boundarytreecode.cc
+ * @brief NPDE homework StableEvaluationAtAPoint
+ * @author Amélie Loher, Erick Schulz & Philippe Peter
+ * @date 29.11.2021
+ * @copyright Developed at ETH Zurich
+ */
+
+#include "boundarytreecode.h"
+
+#include <lf/base/base.h>
+
+#include <Eigen/Core>
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <numeric>
+#include <vector>
+
+#include "parallelfor.h"
+
+namespace StableEvaluationAtAPoint {
+
+BoundaryTreecode::BoundaryTreecode(const BoundaryQuadratureCache &cache,
+                                   double tol, unsigned int leaf_size)
+    : leaf_size_(std::max(1u, leaf_size)) {
+  LF_ASSERT_MSG(tol > 0.0, "Tolerance must be positive");
+  // The truncation error of an accepted box is bounded by
+  // Theta()^(p+1) / (1 - Theta()) = Theta()^p relative to the weights in it
+  order_ = static_cast<unsigned int>(
+      std::clamp(std::ceil(std::log(tol) / std::log(Theta())), 1.0, 60.0));
+
+  const Eigen::Index N = cache.NumPoints();
+  perm_.resize(N);
+  std::iota(perm_.begin(), perm_.end(), 0);
+  sources_.resize(N);
+  for (Eigen::Index k = 0; k < N; ++k) {
+    sources_[k] = {cache.Points()(0, k), cache.Points()(1, k)};
+  }
+  if (N > 0) {
+    Build(0, N);
+  }
+
+  // Permute the data of the sources into tree order
+  std::vector<std::complex<double>> midpoints(N);
+  weights_.resize(N);
+  normals_.resize(N);
+  for (Eigen::Index k = 0; k < N; ++k) {
+    const Eigen::Index e = perm_[k];
+    midpoints[k] = sources_[e];
+    weights_[k] = cache.Weights()[e];
+    normals_[k] = {cache.Normals()(0, e), cache.Normals()(1, e)};
+  }
+  sources_ = std::move(midpoints);
+}
+
+Eigen::Index BoundaryTreecode::Build(Eigen::Index begin, Eigen::Index end) {
+  // Bounding box of the sources, sources_[k] still refers to the quadrature
+  // point k of the cache here
+  double x_min = INFINITY, x_max = -INFINITY;
+  double y_min = INFINITY, y_max = -INFINITY;
+  for (Eigen::Index k = begin; k < end; ++k) {
+    const std::complex<double> z = sources_[perm_[k]];
+    x_min = std::min(x_min, z.real());
+    x_max = std::max(x_max, z.real());
+    y_min = std::min(y_min, z.imag());
+    y_max = std::max(y_max, z.imag());
+  }
+  const Eigen::Index idx = nodes_.size();
+  Node node;
+  node.begin = begin;
+  node.end = end;
+  node.center = {0.5 * (x_min + x_max), 0.5 * (y_min + y_max)};
+  node.radius = 0.5 * std::hypot(x_max - x_min, y_max - y_min);
+  nodes_.push_back(node);
+
+  if (end - begin > static_cast<Eigen::Index>(leaf_size_)) {
+    // Split at the median along the longer side of the box
+    const bool split_x = (x_max - x_min) >= (y_max - y_min);
+    const Eigen::Index mid = begin + (end - begin) / 2;
+    const auto less = [this, split_x](Eigen::Index a, Eigen::Index b) {
+      return split_x ? sources_[a].real() < sources_[b].real()
+                     : sources_[a].imag() < sources_[b].imag();
+    };
+    std::nth_element(perm_.begin() + begin, perm_.begin() + mid,
+                     perm_.begin() + end, less);
+    const Eigen::Index left = Build(begin, mid);
+    const Eigen::Index right = Build(mid, end);
+    nodes_[idx].left = left;
+    nodes_[idx].right = right;
+  }
+  return idx;
+}
+
+std::vector<std::complex<double>> BoundaryTreecode::Expansions(
+    const std::vector<std::complex<double>> &w, bool log) const {
+  const unsigned int P = order_ + 1;
+  std::vector<std::complex<double>> coeffs(nodes_.size() * P, 0.0);
+  for (std::size_t n = 0; n < nodes_.size(); ++n) {
+    const Node &node = nodes_[n];
+    std::complex<double> *a = &coeffs[n * P];
+    for (Eigen::Index k = node.begin; k < node.end; ++k) {
+      const std::complex<double> d = sources_[k] - node.center;
+      // a_j = sum_k w_k (z_k - c)^j
+      std::complex<double> pow = w[k];
+      a[0] += pow;
+      for (unsigned int j = 1; j < P; ++j) {
+        pow *= d;
+        a[j] += log ? pow / static_cast<double>(j) : pow;
+      }
+    }
+  }
+  return coeffs;
+}
+
+std::complex<double> BoundaryTreecode::Sum(
+    const std::vector<std::complex<double>> &w,
+    const std::vector<std::complex<double>> &coeffs, std::complex<double> z,
+    bool log) const {
+  const unsigned int P = order_ + 1;
+  std::complex<double> sum = 0.0;
+  std::vector<Eigen::Index> stack{0};
+  while (!stack.empty()) {
+    const Node &node = nodes_[stack.back()];
+    const std::complex<double> *a = &coeffs[stack.back() * P];
+    stack.pop_back();
+    const std::complex<double> zc = z - node.center;
+    if (node.radius <= Theta() * std::abs(zc)) {
+      // Far field: Horner scheme in 1/(z - c)
+      const std::complex<double> inv = 1.0 / zc;
+      std::complex<double> s = 0.0;
+      for (unsigned int j = P - 1; j >= 1; --j) {
+        s = (s + a[j]) * inv;
+      }
+      sum += log ? a[0] * std::log(zc) - s : (s + a[0]) * inv;
+    } else if (node.left < 0) {
+      // Near field: direct summation over the leaf
+      for (Eigen::Index k = node.begin; k < node.end; ++k) {
+        sum += log ? w[k] * std::log(z - sources_[k])
+                   : w[k] / (z - sources_[k]);
+      }
+    } else {
+      stack.push_back(node.left);
+      stack.push_back(node.right);
+    }
+  }
+  return sum;
+}
+
+// With z = x_0 + i x_1 we have G_x(y) = -Re log(z - y) / (2 pi) and
+// grad G_x(y) . n = Re(n / (z - y)) / (2 pi).
+Eigen::VectorXd BoundaryTreecode::SingleLayer(const Eigen::VectorXd &v_vals,
+                                              const Eigen::Matrix2Xd &xs,
+                                              unsigned int num_threads) const {
+  LF_ASSERT_MSG(v_vals.size() == weights_.size(),
+                "One density value per quadrature point required");
+  std::vector<std::complex<double>> w(weights_.size());
+  for (Eigen::Index k = 0; k < weights_.size(); ++k) {
+    w[k] = v_vals[perm_[k]] * weights_[k];
+  }
+  const std::vector<std::complex<double>> coeffs = Expansions(w, true);
+
+  Eigen::VectorXd vals = Eigen::VectorXd::Zero(xs.cols());
+  if (nodes_.empty()) {
+    return vals;
+  }
+  ParallelFor(xs.cols(), num_threads, [&](Eigen::Index begin,
+                                          Eigen::Index end) {
+    for (Eigen::Index i = begin; i < end; ++i) {
+      vals[i] = -Sum(w, coeffs, {xs(0, i), xs(1, i)}, true).real() /
+                (2.0 * M_PI);
+    }
+  });
+  return vals;
+}
+
+Eigen::VectorXd BoundaryTreecode::DoubleLayer(const Eigen::VectorXd &v_vals,
+                                              const Eigen::Matrix2Xd &xs,
+                                              unsigned int num_threads) const {
+  LF_ASSERT_MSG(v_vals.size() == weights_.size(),
+                "One density value per quadrature point required");
+  std::vector<std::complex<double>> w(weights_.size());
+  for (Eigen::Index k = 0; k < weights_.size(); ++k) {
+    w[k] = v_vals[perm_[k]] * weights_[k] * normals_[k];
+  }
+  const std::vector<std::complex<double>> coeffs = Expansions(w, false);
+
+  Eigen::VectorXd vals = Eigen::VectorXd::Zero(xs.cols());
+  if (nodes_.empty()) {
+    return vals;
+  }
+  ParallelFor(xs.cols(), num_threads, [&](Eigen::Index begin,
+                                          Eigen::Index end) {
+    for (Eigen::Index i = begin; i < end; ++i) {
+      vals[i] =
+          Sum(w, coeffs, {xs(0, i), xs(1, i)}, false).real() / (2.0 * M_PI);
+    }
+  });
+  return vals;
+}
+
+}  // namespace StableEvaluationAtAPoint
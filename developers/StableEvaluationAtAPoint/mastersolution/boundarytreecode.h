@@ -0,0 +1,92 @@
+#ifndef BOUNDARY_TREECODE_H
+#define BOUNDARY_TREECODE_H
+
+/**
+ * @file boundarytreecode.h
+ * @brief NPDE homework StableEvaluationAtAPoint
+ * @author Amélie Loher, Erick Schulz & Philippe Peter
+ * @date 29.11.2021
+ * @copyright Developed at ETH Zurich
+ */
+
+#include <Eigen/Core>
+#include <complex>
+#include <vector>
+
+#include "boundaryquadraturecache.h"
+
+namespace StableEvaluationAtAPoint {
+
+/** @brief Treecode approximating the quadrature sums of P_SL and P_DL at many
+ * evaluation points
+ *
+ * The quadrature points on the boundary are sorted into a binary tree of
+ * bounding boxes.
+ * Identifying R^2 with C, the contribution of the sources in a box with
+ * center c to a point z far from the box is replaced by a truncated
+ * multipole expansion in powers of 1/(z - c):
+ *   sum_k q_k log(z - z_k) = Q log(z - c) - sum_j a_j / (j (z - c)^j),
+ *   sum_k b_k / (z - z_k) = sum_j b_j / (z - c)^(j+1).
+ * A box is accepted if its radius is at most Theta() times the distance of z
+ * to its center, otherwise its children are visited and leaves are summed
+ * directly. This reduces the cost of M evaluations with N quadrature points
+ * on the boundary from O(M N) to O((M + N) log N).
+ */
+class BoundaryTreecode {
+ public:
+  /** @brief Builds the tree for the quadrature points stored in cache
+   * @param tol relative accuracy of the expansions with respect to the sum of
+   * the absolute values of the weights, determines the expansion order
+   * @param leaf_size maximal number of sources in a leaf
+   */
+  explicit BoundaryTreecode(const BoundaryQuadratureCache &cache,
+                            double tol = 1.0E-10, unsigned int leaf_size = 16);
+
+  /** @brief Approximates PSLMultiValues(cache, v_vals, xs) */
+  Eigen::VectorXd SingleLayer(const Eigen::VectorXd &v_vals,
+                              const Eigen::Matrix2Xd &xs,
+                              unsigned int num_threads = 0) const;
+  /** @brief Approximates PDLMultiValues(cache, v_vals, xs) */
+  Eigen::VectorXd DoubleLayer(const Eigen::VectorXd &v_vals,
+                              const Eigen::Matrix2Xd &xs,
+                              unsigned int num_threads = 0) const;
+
+  unsigned int Order() const { return order_; }
+  static double Theta() { return 0.5; }
+
+ private:
+  struct Node {
+    // Sources of the node are sources_[begin, end) in tree order
+    Eigen::Index begin, end;
+    // Children in nodes_, -1 for leaves
+    Eigen::Index left = -1, right = -1;
+    std::complex<double> center;
+    double radius;
+  };
+
+  // Builds the subtree for the sources [begin, end) and returns its index
+  Eigen::Index Build(Eigen::Index begin, Eigen::Index end);
+  // Multipole coefficients of all nodes for the complex weights w, stored
+  // with stride order_ + 1. For log = true the expansion of the logarithm,
+  // entry 0 holding the total weight Q, otherwise the one of 1/(z - z_k).
+  std::vector<std::complex<double>> Expansions(
+      const std::vector<std::complex<double>> &w, bool log) const;
+  // Traverses the tree for the point z and returns the complex sum
+  std::complex<double> Sum(const std::vector<std::complex<double>> &w,
+                           const std::vector<std::complex<double>> &coeffs,
+                           std::complex<double> z, bool log) const;
+
+  // Points, weights and outer normals permuted into tree order
+  std::vector<std::complex<double>> sources_;
+  Eigen::VectorXd weights_;
+  std::vector<std::complex<double>> normals_;
+  // Position in the cache for every source in tree order
+  std::vector<Eigen::Index> perm_;
+  std::vector<Node> nodes_;
+  unsigned int leaf_size_;
+  unsigned int order_;
+};
+
+}  // namespace StableEvaluationAtAPoint
+
+#endif  // BOUNDARY_TREECODE_H
@@ -0,0 +1,143 @@
+/**
+ * @file csrassembler.cc
+ * @brief NPDE homework StableEvaluationAtAPoint
+ * @author Amélie Loher, Erick Schulz & Philippe Peter
+ * @date 29.11.2021
+ * @copyright Developed at ETH Zurich
+ */
+
+#include "csrassembler.h"
+
+#include <Eigen/Core>
+#include <Eigen/SparseCore>
+#include <algorithm>
+#include <vector>
+
+#include "parallelfor.h"
+
+namespace StableEvaluationAtAPoint {
+
+CSRAssembler::CSRAssembler(const lf::assemble::DofHandler &dofh,
+                           unsigned int num_threads)
+    : dofh_(dofh), num_threads_(num_threads) {
+  const Eigen::Index N = dofh_.NumDofs();
+  const auto cells = dofh_.Mesh()->Entities(0);
+  cells_.assign(cells.begin(), cells.end());
+
+  // Upper bound for the number of entries in every column, duplicates
+  // included
+  std::vector<Eigen::Index> offsets(N + 1, 0);
+  for (const lf::mesh::Entity *cell : cells_) {
+    const auto dofs = dofh_.GlobalDofIndices(*cell);
+    for (auto j : dofs) {
+      offsets[j + 1] += dofs.size();
+    }
+  }
+  for (Eigen::Index j = 0; j < N; ++j) {
+    offsets[j + 1] += offsets[j];
+  }
+
+  // Row indices of every column in one flat array
+  std::vector<int> rows(offsets[N]);
+  std::vector<Eigen::Index> fill(offsets.begin(), offsets.end() - 1);
+  for (const lf::mesh::Entity *cell : cells_) {
+    const auto dofs = dofh_.GlobalDofIndices(*cell);
+    for (auto j : dofs) {
+      for (auto i : dofs) {
+        rows[fill[j]++] = static_cast<int>(i);
+      }
+    }
+  }
+
+  // Sort and remove duplicates column by column
+  Eigen::VectorXi col_sizes(N);
+  for (Eigen::Index j = 0; j < N; ++j) {
+    auto begin = rows.begin() + offsets[j];
+    std::sort(begin, rows.begin() + offsets[j + 1]);
+    col_sizes[j] = static_cast<int>(
+        std::unique(begin, rows.begin() + offsets[j + 1]) - begin);
+  }
+
+  pattern_.resize(N, N);
+  pattern_.reserve(col_sizes);
+  for (Eigen::Index j = 0; j < N; ++j) {
+    for (Eigen::Index k = 0; k < col_sizes[j]; ++k) {
+      pattern_.insert(rows[offsets[j] + k], j) = 0.0;
+    }
+  }
+  pattern_.makeCompressed();
+
+  if (num_threads_ != 1) {
+    // Element matrices are stored column by column
+    matrix_map_ = BuildGatherMap(
+        pattern_.nonZeros(), [](Eigen::Index n) { return n * n; },
+        [this](const auto &dofs, Eigen::Index l) {
+          const Eigen::Index n = dofs.size();
+          return Position(dofs[l % n], dofs[l / n]);
+        });
+    vector_map_ = BuildGatherMap(
+        N, [](Eigen::Index n) { return n; },
+        [](const auto &dofs, Eigen::Index l) { return Eigen::Index(dofs[l]); });
+  }
+}
+
+Eigen::Index CSRAssembler::Position(Eigen::Index i, Eigen::Index j) const {
+  const int *inner = pattern_.innerIndexPtr();
+  const int *begin = inner + pattern_.outerIndexPtr()[j];
+  const int *end = inner + pattern_.outerIndexPtr()[j + 1];
+  const int *pos = std::lower_bound(begin, end, int(i));
+  LF_ASSERT_MSG(pos != end && *pos == int(i),
+                "Entry missing in sparsity pattern");
+  return pos - inner;
+}
+
+template <typename SIZE, typename POSITION>
+CSRAssembler::GatherMap CSRAssembler::BuildGatherMap(
+    Eigen::Index N_entries, SIZE &&local_size, POSITION &&position) const {
+  GatherMap map;
+  const Eigen::Index N_cells = cells_.size();
+  map.offsets.assign(N_cells + 1, 0);
+  map.source_offsets.assign(N_entries + 1, 0);
+  // Count the contributions to every entry
+  for (Eigen::Index c = 0; c < N_cells; ++c) {
+    const auto dofs = dofh_.GlobalDofIndices(*cells_[c]);
+    const Eigen::Index n_local = local_size(Eigen::Index(dofs.size()));
+    map.offsets[c + 1] = map.offsets[c] + n_local;
+    for (Eigen::Index l = 0; l < n_local; ++l) {
+      ++map.source_offsets[position(dofs, l) + 1];
+    }
+  }
+  for (Eigen::Index k = 0; k < N_entries; ++k) {
+    map.source_offsets[k + 1] += map.source_offsets[k];
+  }
+  // Cells are visited in ascending order, so are the sources of every entry
+  map.sources.resize(map.offsets.back());
+  std::vector<Eigen::Index> fill(map.source_offsets.begin(),
+                                 map.source_offsets.end() - 1);
+  for (Eigen::Index c = 0; c < N_cells; ++c) {
+    const auto dofs = dofh_.GlobalDofIndices(*cells_[c]);
+    const Eigen::Index n_local = map.offsets[c + 1] - map.offsets[c];
+    for (Eigen::Index l = 0; l < n_local; ++l) {
+      map.sources[fill[position(dofs, l)]++] = map.offsets[c] + l;
+    }
+  }
+  return map;
+}
+
+void CSRAssembler::Gather(const GatherMap &map,
+                          const std::vector<double> &buffer,
+                          double *values) const {
+  ParallelFor(Eigen::Index(map.source_offsets.size()) - 1, num_threads_,
+              [&](Eigen::Index begin, Eigen::Index end) {
+                for (Eigen::Index k = begin; k < end; ++k) {
+                  double sum = 0.0;
+                  for (Eigen::Index s = map.source_offsets[k];
+                       s < map.source_offsets[k + 1]; ++s) {
+                    sum += buffer[map.sources[s]];
+                  }
+                  values[k] = sum;
+                }
+              });
+}
+
+}  // namespace StableEvaluationAtAPoint
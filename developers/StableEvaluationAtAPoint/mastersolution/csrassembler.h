@@ -0,0 +1,224 @@
+#ifndef CSR_ASSEMBLER_H
+#define CSR_ASSEMBLER_H
+
+/**
+ * @file csrassembler.h
+ * @brief NPDE homework StableEvaluationAtAPoint
+ * @author Amélie Loher, Erick Schulz & Philippe Peter
+ * @date 29.11.2021
+ * @copyright Developed at ETH Zurich
+ */
+
+#include <lf/assemble/assemble.h>
+#include <lf/base/base.h>
+#include <lf/mesh/mesh.h>
+
+#include <Eigen/Core>
+#include <Eigen/SparseCore>
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "parallelfor.h"
+
+namespace StableEvaluationAtAPoint {
+
+/** @brief Assembly of Galerkin matrices directly in compressed sparse format
+ *
+ * lf::assemble::COOMatrix stores one triplet per entry of every element
+ * matrix, which are sorted and summed by makeSparse(). Instead, the sparsity
+ * pattern is computed once from the cell-to-dof connectivity of the
+ * DofHandler, and the element matrices are added directly to the value array
+ * of a compressed matrix with this pattern. Repeated assemblies reuse the
+ * pattern. The matrices are column major, which for the symmetric pattern
+ * coincides with the CSR layout. Optionally, the element matrices are
+ * computed by several threads.
+ */
+class CSRAssembler {
+ public:
+  /** @brief Builds the sparsity pattern of matrices coupling all dofs that
+   * belong to a common cell
+   * @param dofh DofHandler, must outlive the CSRAssembler
+   * @param num_threads number of threads used by Assemble() and
+   * AssembleVector(), 0 selects the number of hardware threads
+   */
+  explicit CSRAssembler(const lf::assemble::DofHandler &dofh,
+                        unsigned int num_threads = 1);
+
+  /** @brief Compressed matrix with the sparsity pattern and zero values */
+  const Eigen::SparseMatrix<double> &Pattern() const { return pattern_; }
+  unsigned int NumThreads() const { return num_threads_; }
+
+  /** @brief Assembles the Galerkin matrix from the element matrices of the
+   * active cells
+   * @param provider element matrix provider as for
+   * lf::assemble::AssembleMatrixLocally(). With more than one thread its
+   * methods are called concurrently and must be thread safe.
+   *
+   * With several threads, the element matrices are computed in parallel and
+   * stored. Then every matrix entry sums its contributions in the order of
+   * the cells, so the result is bitwise identical to the serial assembly.
+   */
+  template <typename ENTITY_MATRIX_PROVIDER>
+  Eigen::SparseMatrix<double> Assemble(ENTITY_MATRIX_PROVIDER &provider) const;
+
+  /** @brief Assembles the right-hand side vector from the element vectors of
+   * the active cells, see Assemble()
+   */
+  template <typename ENTITY_VECTOR_PROVIDER>
+  Eigen::VectorXd AssembleVector(ENTITY_VECTOR_PROVIDER &provider) const;
+
+ private:
+  // Index in the value array of pattern_ of the entry (i, j)
+  Eigen::Index Position(Eigen::Index i, Eigen::Index j) const;
+
+  // Contributions of the element matrices or vectors of all cells to one
+  // matrix or vector entry. The local values of cell c are stored at
+  // offsets[c], ... in a buffer, entry k sums the buffer values at
+  // sources[source_offsets[k]], ..., in ascending order of the cells.
+  struct GatherMap {
+    std::vector<Eigen::Index> offsets;
+    std::vector<Eigen::Index> source_offsets;
+    std::vector<Eigen::Index> sources;
+  };
+  // Builds the map for the local entries of every cell, local_size(n) is
+  // their number for n dofs, position(dofs, l) the global index of entry l
+  template <typename SIZE, typename POSITION>
+  GatherMap BuildGatherMap(Eigen::Index N_entries, SIZE &&local_size,
+                           POSITION &&position) const;
+  // Sums the buffer values of every entry in parallel
+  void Gather(const GatherMap &map, const std::vector<double> &buffer,
+              double *values) const;
+
+  const lf::assemble::DofHandler &dofh_;
+  unsigned int num_threads_;
+  std::vector<const lf::mesh::Entity *> cells_;
+  Eigen::SparseMatrix<double> pattern_;
+  // Only built if num_threads_ != 1
+  GatherMap matrix_map_;
+  GatherMap vector_map_;
+};
+
+template <typename ENTITY_MATRIX_PROVIDER>
+Eigen::SparseMatrix<double> CSRAssembler::Assemble(
+    ENTITY_MATRIX_PROVIDER &provider) const {
+  Eigen::SparseMatrix<double> A = pattern_;
+  double *values = A.valuePtr();
+  if (num_threads_ == 1) {
+    for (const lf::mesh::Entity *cell : cells_) {
+      if (!provider.isActive(*cell)) {
+        continue;
+      }
+      const auto elmat = provider.Eval(*cell);
+      const auto dofs = dofh_.GlobalDofIndices(*cell);
+      for (Eigen::Index j = 0; j < elmat.cols(); ++j) {
+        for (Eigen::Index i = 0; i < elmat.rows(); ++i) {
+          values[Position(dofs[i], dofs[j])] += elmat(i, j);
+        }
+      }
+    }
+    return A;
+  }
+
+  // Element matrices of inactive cells are zero
+  std::vector<double> buffer(matrix_map_.offsets.back(), 0.0);
+  ParallelFor(
+      Eigen::Index(cells_.size()), num_threads_,
+      [&](Eigen::Index begin, Eigen::Index end) {
+        for (Eigen::Index c = begin; c < end; ++c) {
+          if (!provider.isActive(*cells_[c])) {
+            continue;
+          }
+          const auto elmat = provider.Eval(*cells_[c]);
+          double *local = buffer.data() + matrix_map_.offsets[c];
+          for (Eigen::Index j = 0; j < elmat.cols(); ++j) {
+            for (Eigen::Index i = 0; i < elmat.rows(); ++i) {
+              local[j * elmat.rows() + i] = elmat(i, j);
+            }
+          }
+        }
+      });
+  Gather(matrix_map_, buffer, values);
+  return A;
+}
+
+template <typename ENTITY_VECTOR_PROVIDER>
+Eigen::VectorXd CSRAssembler::AssembleVector(
+    ENTITY_VECTOR_PROVIDER &provider) const {
+  Eigen::VectorXd phi = Eigen::VectorXd::Zero(pattern_.rows());
+  if (num_threads_ == 1) {
+    for (const lf::mesh::Entity *cell : cells_) {
+      if (!provider.isActive(*cell)) {
+        continue;
+      }
+      const auto elvec = provider.Eval(*cell);
+      const auto dofs = dofh_.GlobalDofIndices(*cell);
+      for (Eigen::Index i = 0; i < elvec.size(); ++i) {
+        phi[dofs[i]] += elvec[i];
+      }
+    }
+    return phi;
+  }
+
+  std::vector<double> buffer(vector_map_.offsets.back(), 0.0);
+  ParallelFor(
+      Eigen::Index(cells_.size()), num_threads_,
+      [&](Eigen::Index begin, Eigen::Index end) {
+        for (Eigen::Index c = begin; c < end; ++c) {
+          if (!provider.isActive(*cells_[c])) {
+            continue;
+          }
+          const auto elvec = provider.Eval(*cells_[c]);
+          double *local = buffer.data() + vector_map_.offsets[c];
+          for (Eigen::Index i = 0; i < elvec.size(); ++i) {
+            local[i] = elvec[i];
+          }
+        }
+      });
+  Gather(vector_map_, buffer, phi.data());
+  return phi;
+}
+
+/** @brief Eliminates the flagged dofs from the linear system A x = phi in
+ * the same way as lf::assemble::FixFlaggedSolutionComponents(), but for a
+ * compressed matrix. Its rows and columns are replaced by those of the
+ * identity without changing the sparsity pattern.
+ * @param selector returns the pair (flag, value) for a dof index
+ */
+template <typename SELECTOR>
+void FixFlaggedSolutionComponentsCSR(SELECTOR &&selector,
+                                     Eigen::SparseMatrix<double> &A,
+                                     Eigen::VectorXd &phi) {
+  const Eigen::Index N = A.rows();
+  Eigen::VectorXd g = Eigen::VectorXd::Zero(N);
+  std::vector<bool> flags(N);
+  for (Eigen::Index i = 0; i < N; ++i) {
+    const std::pair<bool, double> fv = selector(i);
+    flags[i] = fv.first;
+    if (fv.first) {
+      g[i] = fv.second;
+    }
+  }
+  for (Eigen::Index j = 0; j < A.outerSize(); ++j) {
+    for (Eigen::SparseMatrix<double>::InnerIterator it(A, j); it; ++it) {
+      const Eigen::Index i = it.row();
+      if (flags[j]) {
+        if (!flags[i]) {
+          phi[i] -= it.value() * g[j];
+        }
+        it.valueRef() = i == j ? 1.0 : 0.0;
+      } else if (flags[i]) {
+        it.valueRef() = 0.0;
+      }
+    }
+  }
+  for (Eigen::Index i = 0; i < N; ++i) {
+    if (flags[i]) {
+      phi[i] = g[i];
+    }
+  }
+}
+
+}  // namespace StableEvaluationAtAPoint
+
+#endif  // CSR_ASSEMBLER_H
@@ -10,6 +10,37 @@ set(SOURCES
   ${DIR}/stableevaluationatapoint_main.cc
   ${DIR}/stableevaluationatapoint.h
   ${DIR}/stableevaluationatapoint.cc
+  ${DIR}/pointlocator.h
+  ${DIR}/pointlocator.cc
+  ${DIR}/boundaryquadraturecache.h
+  ${DIR}/boundaryquadraturecache.cc
+  ${DIR}/boundarytreecode.h
+  ${DIR}/boundarytreecode.cc
+  ${DIR}/linearsolver.h
+  ${DIR}/linearsolver.cc
+  ${DIR}/amgpreconditioner.h
+  ${DIR}/amgpreconditioner.cc
+  ${DIR}/multigrid.h
+  ${DIR}/multigrid.cc
+  ${DIR}/gaussseidel.h
+  ${DIR}/gaussseidel.cc
+  ${DIR}/dirichletsolver.h
+  ${DIR}/dirichletsolver.cc
+  ${DIR}/csrassembler.h
+  ${DIR}/csrassembler.cc
+  ${DIR}/reducedsystem.h
+  ${DIR}/reducedsystem.cc
+  ${DIR}/meshcache.h
+  ${DIR}/meshcache.cc
+  ${DIR}/unitsquaremesh.h
+  ${DIR}/unitsquaremesh.cc
+  ${DIR}/studyoptions.h
+  ${DIR}/studyoptions.cc
+  ${DIR}/profiler.h
+  ${DIR}/profiler.cc
+  ${DIR}/trianglegeometry.h
+  ${DIR}/trianglegeometry.cc
+  ${DIR}/parallelfor.h
 )
 
 set(LIBRARIES
@@ -23,5 +54,7 @@ set(LIBRARIES
   LF::lf.mesh.hybrid2d
   LF::lf.mesh.utils
   LF::lf.quad
+  LF::lf.refinement
   LF::lf.uscalfe
+  Threads::Threads
 )
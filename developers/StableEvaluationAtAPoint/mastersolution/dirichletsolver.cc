@@ -0,0 +1,75 @@
+/**
+ * @file dirichletsolver.cc
+ * @brief NPDE homework StableEvaluationAtAPoint
+ * @author Amélie Loher, Erick Schulz & Philippe Peter
+ * @date 29.11.2021
+ * @copyright Developed at ETH Zurich
+ */
+
+#include "dirichletsolver.h"
+
+#include <lf/assemble/assemble.h>
+#include <lf/base/base.h>
+#include <lf/mesh/utils/utils.h>
+
+#include <Eigen/Core>
+#include <Eigen/SparseCore>
+#include <utility>
+#include <vector>
+
+namespace StableEvaluationAtAPoint {
+
+DirichletSolver::DirichletSolver(
+    std::shared_ptr<lf::uscalfe::FeSpaceLagrangeO1<double>> fe_space_p)
+    : fe_space_p_(std::move(fe_space_p)) {
+  std::shared_ptr<const lf::mesh::Mesh> mesh_p = fe_space_p_->Mesh();
+  const lf::assemble::DofHandler &dofh{fe_space_p_->LocGlobMap()};
+  const lf::assemble::size_type N_dofs = dofh.NumDofs();
+
+  // Galerkin matrix of the Laplacian
+  lf::assemble::COOMatrix<double> A(N_dofs, N_dofs);
+  lf::uscalfe::LinearFELaplaceElementMatrix elmat_builder{};
+  lf::assemble::AssembleMatrixLocally(0, dofh, dofh, elmat_builder, A);
+
+  // Dirichlet dofs are the dofs on boundary edges, as in SolveBVP()
+  auto bd_flags{lf::mesh::utils::flagEntitiesOnBoundary(mesh_p, 1)};
+  std::vector<bool> is_boundary(N_dofs, false);
+  for (const lf::mesh::Entity *edge : mesh_p->Entities(1)) {
+    if (bd_flags(*edge)) {
+      for (lf::assemble::gdof_idx_t dof : dofh.GlobalDofIndices(*edge)) {
+        is_boundary[dof] = true;
+      }
+    }
+  }
+  for (lf::assemble::size_type i = 0; i < N_dofs; ++i) {
+    if (is_boundary[i]) {
+      boundary_dofs_.push_back(i);
+    }
+  }
+
+  // Split off the Dirichlet dofs and factorize the interior system
+  reduced_ = ReducedSystem(A.makeSparse(), is_boundary);
+  if (reduced_.NumInterior() > 0) {
+    solver_.compute(reduced_.Matrix());
+    LF_VERIFY_MSG(solver_.info() == Eigen::Success,
+                  "LDLT decomposition failed");
+  }
+}
+
+Eigen::VectorXd DirichletSolver::SolveBoundaryValues(
+    const Eigen::VectorXd &g_vals) const {
+  return SolveBoundaryValues(Eigen::MatrixXd(g_vals)).col(0);
+}
+
+Eigen::MatrixXd DirichletSolver::SolveBoundaryValues(
+    const Eigen::MatrixXd &G) const {
+  LF_ASSERT_MSG(G.rows() == reduced_.NumDofs(), "Size mismatch");
+  if (reduced_.NumInterior() == 0) {
+    return G;
+  }
+  const Eigen::MatrixXd X_I = solver_.solve(-reduced_.Lifting(G));
+  LF_VERIFY_MSG(solver_.info() == Eigen::Success, "Solving LSE failed");
+  return reduced_.Expand(X_I, G);
+}
+
+}  // namespace StableEvaluationAtAPoint
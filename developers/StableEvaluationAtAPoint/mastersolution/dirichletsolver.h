@@ -0,0 +1,95 @@
+#ifndef DIRICHLET_SOLVER_H
+#define DIRICHLET_SOLVER_H
+
+/**
+ * @file dirichletsolver.h
+ * @brief NPDE homework StableEvaluationAtAPoint
+ * @author Amélie Loher, Erick Schulz & Philippe Peter
+ * @date 29.11.2021
+ * @copyright Developed at ETH Zurich
+ */
+
+#include <lf/fe/fe.h>
+#include <lf/mesh/utils/utils.h>
+#include <lf/uscalfe/uscalfe.h>
+
+#include <Eigen/Core>
+#include <Eigen/SparseCholesky>
+#include <Eigen/SparseCore>
+#include <memory>
+#include <vector>
+
+#include "reducedsystem.h"
+
+namespace StableEvaluationAtAPoint {
+
+/** @brief Solver for the Laplace equation with varying Dirichlet data on a
+ * fixed finite element space
+ *
+ * The Galerkin matrix does not depend on the boundary data g. It is
+ * assembled, the Dirichlet dofs are eliminated as in SolveBVPReduced() and
+ * the s.p.d. interior matrix is factorized once by the constructor. A solve
+ * for new data then only requires the lifting of g into the right-hand side
+ * and two triangular solves. Blocks of boundary data are solved at once.
+ */
+class DirichletSolver {
+ public:
+  explicit DirichletSolver(
+      std::shared_ptr<lf::uscalfe::FeSpaceLagrangeO1<double>> fe_space_p);
+
+  std::shared_ptr<lf::uscalfe::FeSpaceLagrangeO1<double>> FeSpace() const {
+    return fe_space_p_;
+  }
+  /** @brief Indices of the Dirichlet dofs, i.e. dofs on the boundary */
+  const std::vector<Eigen::Index> &BoundaryDofs() const {
+    return boundary_dofs_;
+  }
+
+  /** @brief Vector of dof values holding the values of g at the Dirichlet
+   * dofs and 0 elsewhere
+   */
+  template <typename FUNCTOR>
+  Eigen::VectorXd BoundaryValues(FUNCTOR &&g) const;
+
+  /** @brief Solves for the Dirichlet data g, same result as SolveBVP() */
+  template <typename FUNCTOR>
+  Eigen::VectorXd Solve(FUNCTOR &&g) const {
+    return SolveBoundaryValues(BoundaryValues(g));
+  }
+
+  /** @brief Solves for the Dirichlet data given by dof values
+   * @param g_vals only the entries of the Dirichlet dofs are used
+   */
+  Eigen::VectorXd SolveBoundaryValues(const Eigen::VectorXd &g_vals) const;
+
+  /** @brief Solves for several Dirichlet data at once
+   * @param G one vector of dof values per column, see SolveBoundaryValues()
+   * above
+   * @return solution for column j of G in column j
+   */
+  Eigen::MatrixXd SolveBoundaryValues(const Eigen::MatrixXd &G) const;
+
+ private:
+  std::shared_ptr<lf::uscalfe::FeSpaceLagrangeO1<double>> fe_space_p_;
+  std::vector<Eigen::Index> boundary_dofs_;
+  ReducedSystem reduced_;
+  Eigen::SimplicialLDLT<Eigen::SparseMatrix<double>> solver_;
+};
+
+template <typename FUNCTOR>
+Eigen::VectorXd DirichletSolver::BoundaryValues(FUNCTOR &&g) const {
+  lf::mesh::utils::MeshFunctionGlobal mf_g{g};
+  auto bd_flags{
+      lf::mesh::utils::flagEntitiesOnBoundary(fe_space_p_->Mesh(), 1)};
+  auto flag_values{lf::fe::InitEssentialConditionFromFunction(
+      *fe_space_p_, bd_flags, mf_g)};
+  Eigen::VectorXd g_vals = Eigen::VectorXd::Zero(flag_values.size());
+  for (Eigen::Index i : boundary_dofs_) {
+    g_vals[i] = flag_values[i].second;
+  }
+  return g_vals;
+}
+
+}  // namespace StableEvaluationAtAPoint
+
+#endif  // DIRICHLET_SOLVER_H
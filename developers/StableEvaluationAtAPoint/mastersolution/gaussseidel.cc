@@ -0,0 +1,37 @@
+/**
+ * @file gaussseidel.cc
+ * @brief NPDE homework StableEvaluationAtAPoint
+ * @author Amélie Loher, Erick Schulz & Philippe Peter
+ * @date 29.11.2021
+ * @copyright Developed at ETH Zurich
+ */
+
+#include "gaussseidel.h"
+
+#include <Eigen/Core>
+#include <Eigen/SparseCore>
+
+namespace StableEvaluationAtAPoint {
+
+void GaussSeidel(const Eigen::SparseMatrix<double, Eigen::RowMajor> &A,
+                 const Eigen::VectorXd &b, Eigen::VectorXd &x, bool forward) {
+  using RowMatrix = Eigen::SparseMatrix<double, Eigen::RowMajor>;
+  const Eigen::Index n = A.rows();
+  for (Eigen::Index k = 0; k < n; ++k) {
+    const Eigen::Index i = forward ? k : n - 1 - k;
+    double diag = 0.0;
+    double sum = b[i];
+    for (RowMatrix::InnerIterator it(A, i); it; ++it) {
+      if (it.col() == i) {
+        diag = it.value();
+      } else {
+        sum -= it.value() * x[it.col()];
+      }
+    }
+    if (diag != 0.0) {
+      x[i] = sum / diag;
+    }
+  }
+}
+
+}  // namespace StableEvaluationAtAPoint
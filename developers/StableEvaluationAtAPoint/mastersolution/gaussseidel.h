@@ -0,0 +1,28 @@
+#ifndef GAUSS_SEIDEL_H
+#define GAUSS_SEIDEL_H
+
+/**
+ * @file gaussseidel.h
+ * @brief NPDE homework StableEvaluationAtAPoint
+ * @author Amélie Loher, Erick Schulz & Philippe Peter
+ * @date 29.11.2021
+ * @copyright Developed at ETH Zurich
+ */
+
+#include <Eigen/Core>
+#include <Eigen/SparseCore>
+
+namespace StableEvaluationAtAPoint {
+
+/** @brief One Gauss-Seidel sweep for A x = b, in forward or backward order
+ *
+ * A forward sweep followed by a backward sweep is the symmetric Gauss-Seidel
+ * smoother of the multigrid methods. Rows with a vanishing diagonal entry
+ * are left unchanged.
+ */
+void GaussSeidel(const Eigen::SparseMatrix<double, Eigen::RowMajor> &A,
+                 const Eigen::VectorXd &b, Eigen::VectorXd &x, bool forward);
+
+}  // namespace StableEvaluationAtAPoint
+
+#endif  // GAUSS_SEIDEL_H
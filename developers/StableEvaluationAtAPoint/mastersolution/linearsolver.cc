@@ -0,0 +1,95 @@
+/**
+ * @file linearsolver.cc
+ * @brief NPDE homework StableEvaluationAtAPoint
+ * @author Amélie Loher, Erick Schulz & Philippe Peter
+ * @date 29.11.2021
+ * @copyright Developed at ETH Zurich
+ */
+
+#include "linearsolver.h"
+
+#include <lf/base/base.h>
+
+#include <Eigen/Core>
+#include <Eigen/IterativeLinearSolvers>
+#include <Eigen/SparseCholesky>
+#include <Eigen/SparseCore>
+#include <Eigen/SparseLU>
+
+#include "amgpreconditioner.h"
+#include "profiler.h"
+
+namespace StableEvaluationAtAPoint {
+
+namespace {
+
+// Runs the CG method with the preconditioner PRECONDITIONER
+template <typename PRECONDITIONER>
+Eigen::VectorXd SolveCG(const Eigen::SparseMatrix<double> &A,
+                        const Eigen::VectorXd &b, double tol,
+                        unsigned int &iterations) {
+  Eigen::ConjugateGradient<Eigen::SparseMatrix<double>,
+                           Eigen::Lower | Eigen::Upper, PRECONDITIONER>
+      solver;
+  solver.setTolerance(tol);
+  solver.compute(A);
+  LF_VERIFY_MSG(solver.info() == Eigen::Success,
+                "Setup of the preconditioner failed");
+  Eigen::VectorXd x = solver.solve(b);
+  LF_VERIFY_MSG(solver.info() == Eigen::Success, "CG did not converge");
+  iterations = static_cast<unsigned int>(solver.iterations());
+  return x;
+}
+
+}  // namespace
+
+Eigen::VectorXd SolveLSE(const Eigen::SparseMatrix<double> &A,
+                         const Eigen::VectorXd &b, SolverType type,
+                         SolverInfo *info, double tol) {
+  ScopedTimer timer(Stage::kLinearSolve);
+  Eigen::VectorXd x;
+  unsigned int iterations = 0;
+  switch (type) {
+    case SolverType::kSparseLU: {
+      Eigen::SparseLU<Eigen::SparseMatrix<double>> solver;
+      solver.compute(A);
+      LF_VERIFY_MSG(solver.info() == Eigen::Success, "LU decomposition failed");
+      x = solver.solve(b);
+      LF_VERIFY_MSG(solver.info() == Eigen::Success, "Solving LSE failed");
+      break;
+    }
+    // One level only, which multigrid solves directly
+    case SolverType::kMultigrid:
+    case SolverType::kSimplicialLDLT: {
+      Eigen::SimplicialLDLT<Eigen::SparseMatrix<double>> solver;
+      solver.compute(A);
+      LF_VERIFY_MSG(solver.info() == Eigen::Success,
+                    "LDLT decomposition failed");
+      x = solver.solve(b);
+      LF_VERIFY_MSG(solver.info() == Eigen::Success, "Solving LSE failed");
+      break;
+    }
+    case SolverType::kCGJacobi: {
+      x = SolveCG<Eigen::DiagonalPreconditioner<double>>(A, b, tol,
+                                                         iterations);
+      break;
+    }
+    case SolverType::kCGIncompleteCholesky: {
+      x = SolveCG<Eigen::IncompleteCholesky<double>>(A, b, tol, iterations);
+      break;
+    }
+    case SolverType::kCGAMG: {
+      x = SolveCG<AMGPreconditioner>(A, b, tol, iterations);
+      break;
+    }
+  }
+  if (info != nullptr) {
+    const double b_norm = b.norm();
+    info->iterations = iterations;
+    info->residual =
+        b_norm > 0.0 ? (b - A * x).norm() / b_norm : (A * x).norm();
+  }
+  return x;
+}
+
+}  // namespace StableEvaluationAtAPoint
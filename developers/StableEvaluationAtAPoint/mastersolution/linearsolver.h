@@ -0,0 +1,58 @@
+#ifndef LINEAR_SOLVER_H
+#define LINEAR_SOLVER_H
+
+/**
+ * @file linearsolver.h
+ * @brief NPDE homework StableEvaluationAtAPoint
+ * @author Amélie Loher, Erick Schulz & Philippe Peter
+ * @date 29.11.2021
+ * @copyright Developed at ETH Zurich
+ */
+
+#include <Eigen/Core>
+#include <Eigen/SparseCore>
+
+namespace StableEvaluationAtAPoint {
+
+/** @brief Solvers available for the linear systems of SolveBVP()
+ *
+ * After the elimination of the Dirichlet dofs the Galerkin matrix of the
+ * Laplacian is symmetric positive definite, so besides the general sparse LU
+ * decomposition also the sparse Cholesky (LDL^T) decomposition and the
+ * conjugate gradient method apply. The latter needs no fill-in. With the
+ * algebraic multigrid preconditioner its iteration count is independent of
+ * the mesh size. The geometric multigrid method of MultigridHierarchy needs
+ * a hierarchy of regularly refined meshes, which the driver builds from the
+ * coarsest mesh. Given a single matrix, the hierarchy consists of one level,
+ * on which kMultigrid is the sparse Cholesky solver of the coarsest level.
+ */
+enum class SolverType {
+  kSparseLU,
+  kSimplicialLDLT,
+  kCGJacobi,
+  kCGIncompleteCholesky,
+  kCGAMG,
+  kMultigrid
+};
+
+/** @brief Statistics of a linear solve */
+struct SolverInfo {
+  // Number of iterations, 0 for direct solvers
+  unsigned int iterations = 0;
+  // Relative residual |b - A x| / |b|
+  double residual = 0.0;
+};
+
+/** @brief Solves the sparse linear system A x = b
+ * @param type solver to use, the CG variants require A to be s.p.d.
+ * @param info if not nullptr, receives iteration count and residual
+ * @param tol relative residual at which the CG iteration stops
+ */
+Eigen::VectorXd SolveLSE(const Eigen::SparseMatrix<double> &A,
+                         const Eigen::VectorXd &b,
+                         SolverType type = SolverType::kSparseLU,
+                         SolverInfo *info = nullptr, double tol = 1.0E-12);
+
+}  // namespace StableEvaluationAtAPoint
+
+#endif  // LINEAR_SOLVER_H
@@ -0,0 +1,307 @@
+/**
+ * @file meshcache.cc
+ * @brief NPDE homework StableEvaluationAtAPoint
+ * @author Amélie Loher, Erick Schulz & Philippe Peter
+ * @date 29.11.2021
+ * @copyright Developed at ETH Zurich
+ */
+
+#include "meshcache.h"
+
+#include <fcntl.h>
+#include <lf/base/base.h>
+#include <lf/geometry/geometry.h>
+#include <lf/io/io.h>
+#include <lf/mesh/hybrid2d/hybrid2d.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <Eigen/Core>
+#include <array>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "profiler.h"
+
+namespace StableEvaluationAtAPoint {
+
+namespace {
+
+using size_type = lf::mesh::Mesh::size_type;
+
+// Marks the unused fourth node of triangles
+constexpr std::uint32_t kNoNode = 0xFFFFFFFF;
+
+struct Header {
+  char magic[8];
+  std::uint64_t stamp;
+  std::uint64_t num_nodes;
+  std::uint64_t num_edges;
+  std::uint64_t num_cells;
+};
+constexpr char kMagic[8] = {'L', 'F', 'M', 'E', 'S', 'H', '0', '1'};
+
+// Read-only memory mapping of a whole file
+class MappedFile {
+ public:
+  explicit MappedFile(const std::string &filename) {
+    const int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+      return;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+      const auto size = static_cast<std::size_t>(st.st_size);
+      void *data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (data != MAP_FAILED) {
+        data_ = static_cast<const char *>(data);
+        size_ = size;
+      }
+    }
+    close(fd);
+  }
+  ~MappedFile() {
+    if (data_ != nullptr) {
+      munmap(const_cast<char *>(data_), size_);
+    }
+  }
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  const char *Data() const { return data_; }
+  std::size_t Size() const { return size_; }
+
+ private:
+  const char *data_ = nullptr;
+  std::size_t size_ = 0;
+};
+
+// Reads a binary mesh file, returns nullptr if it is invalid or if
+// expected_stamp is not nullptr and differs from the stamp of the file
+std::shared_ptr<lf::mesh::Mesh> ReadBinaryMeshImpl(
+    const std::string &filename, const std::uint64_t *expected_stamp,
+    std::uint64_t *stamp) {
+  const MappedFile file(filename);
+  if (file.Size() < sizeof(Header)) {
+    return nullptr;
+  }
+  Header header;
+  std::memcpy(&header, file.Data(), sizeof(Header));
+  // Each count is bounded by the file size first, so that the expected size
+  // cannot overflow
+  const std::uint64_t max_count = file.Size() / sizeof(std::uint32_t);
+  if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+      (expected_stamp != nullptr && header.stamp != *expected_stamp) ||
+      header.num_nodes > max_count || header.num_edges > max_count ||
+      header.num_cells > max_count ||
+      file.Size() != sizeof(Header) + 2 * sizeof(double) * header.num_nodes +
+                         2 * sizeof(std::uint32_t) * header.num_edges +
+                         4 * sizeof(std::uint32_t) * header.num_cells) {
+    return nullptr;
+  }
+  if (stamp != nullptr) {
+    *stamp = header.stamp;
+  }
+
+  // The arrays follow the header and are read from the mapped memory
+  const char *coords_data = file.Data() + sizeof(Header);
+  const char *edges_data = coords_data + 2 * sizeof(double) * header.num_nodes;
+  const char *cells_data =
+      edges_data + 2 * sizeof(std::uint32_t) * header.num_edges;
+  auto coord = [coords_data](std::uint64_t k) {
+    double value;
+    std::memcpy(&value, coords_data + k * sizeof(double), sizeof(double));
+    return value;
+  };
+  auto index = [](const char *data, std::uint64_t k) {
+    std::uint32_t value;
+    std::memcpy(&value, data + k * sizeof(std::uint32_t),
+                sizeof(std::uint32_t));
+    return value;
+  };
+
+  // All node indices must refer to existing nodes, only the fourth node of
+  // a cell may be kNoNode
+  for (std::uint64_t k = 0; k < 2 * header.num_edges; ++k) {
+    if (index(edges_data, k) >= header.num_nodes) {
+      return nullptr;
+    }
+  }
+  for (std::uint64_t k = 0; k < 4 * header.num_cells; ++k) {
+    const std::uint32_t node = index(cells_data, k);
+    if (node >= header.num_nodes && !(k % 4 == 3 && node == kNoNode)) {
+      return nullptr;
+    }
+  }
+
+  auto mesh_factory = std::make_unique<lf::mesh::hybrid2d::MeshFactory>(2);
+  for (std::uint64_t i = 0; i < header.num_nodes; ++i) {
+    mesh_factory->AddPoint(Eigen::Vector2d(coord(2 * i), coord(2 * i + 1)));
+  }
+  // Adding the edges explicitly preserves their numbering
+  for (std::uint64_t e = 0; e < header.num_edges; ++e) {
+    const std::array<size_type, 2> nodes{index(edges_data, 2 * e),
+                                         index(edges_data, 2 * e + 1)};
+    Eigen::Matrix2d corners;
+    for (int k = 0; k < 2; ++k) {
+      corners.col(k) << coord(2 * nodes[k]), coord(2 * nodes[k] + 1);
+    }
+    mesh_factory->AddEntity(lf::base::RefEl::kSegment(),
+                            nonstd::span<const size_type>(nodes.data(), 2),
+                            std::make_unique<lf::geometry::SegmentO1>(corners));
+  }
+  for (std::uint64_t c = 0; c < header.num_cells; ++c) {
+    std::array<size_type, 4> nodes;
+    for (int k = 0; k < 4; ++k) {
+      nodes[k] = index(cells_data, 4 * c + k);
+    }
+    const int n = nodes[3] == kNoNode ? 3 : 4;
+    Eigen::Matrix<double, 2, Eigen::Dynamic> corners(2, n);
+    for (int k = 0; k < n; ++k) {
+      corners.col(k) << coord(2 * nodes[k]), coord(2 * nodes[k] + 1);
+    }
+    if (n == 3) {
+      mesh_factory->AddEntity(lf::base::RefEl::kTria(),
+                              nonstd::span<const size_type>(nodes.data(), 3),
+                              std::make_unique<lf::geometry::TriaO1>(corners));
+    } else {
+      mesh_factory->AddEntity(lf::base::RefEl::kQuad(),
+                              nonstd::span<const size_type>(nodes.data(), 4),
+                              std::make_unique<lf::geometry::QuadO1>(corners));
+    }
+  }
+  return mesh_factory->Build();
+}
+
+// Modification time of a file as a number
+std::uint64_t ModificationStamp(const std::filesystem::path &path) {
+  return static_cast<std::uint64_t>(
+      std::filesystem::last_write_time(path).time_since_epoch().count());
+}
+
+struct CacheEntry {
+  std::uint64_t stamp;
+  std::shared_ptr<lf::mesh::Mesh> mesh;
+};
+std::mutex cache_mutex;
+std::map<std::string, CacheEntry> mesh_cache;
+
+}  // namespace
+
+void WriteBinaryMesh(const lf::mesh::Mesh &mesh, const std::string &filename,
+                     std::uint64_t stamp) {
+  LF_VERIFY_MSG(mesh.DimMesh() == 2 && mesh.DimWorld() == 2,
+                "Only 2D meshes are supported");
+  Header header;
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.stamp = stamp;
+  header.num_nodes = mesh.NumEntities(2);
+  header.num_edges = mesh.NumEntities(1);
+  header.num_cells = mesh.NumEntities(0);
+
+  std::vector<double> coords(2 * header.num_nodes);
+  for (const lf::mesh::Entity *node : mesh.Entities(2)) {
+    const Eigen::MatrixXd corner = lf::geometry::Corners(*node->Geometry());
+    coords[2 * mesh.Index(*node)] = corner(0, 0);
+    coords[2 * mesh.Index(*node) + 1] = corner(1, 0);
+  }
+  std::vector<std::uint32_t> edges(2 * header.num_edges);
+  for (const lf::mesh::Entity *edge : mesh.Entities(1)) {
+    int k = 0;
+    for (const lf::mesh::Entity *node : edge->SubEntities(1)) {
+      edges[2 * mesh.Index(*edge) + k++] = mesh.Index(*node);
+    }
+  }
+  std::vector<std::uint32_t> cells(4 * header.num_cells, kNoNode);
+  for (const lf::mesh::Entity *cell : mesh.Entities(0)) {
+    int k = 0;
+    for (const lf::mesh::Entity *node : cell->SubEntities(2)) {
+      cells[4 * mesh.Index(*cell) + k++] = mesh.Index(*node);
+    }
+  }
+
+  std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+  LF_VERIFY_MSG(file.is_open(), "Cannot open " + filename);
+  file.write(reinterpret_cast<const char *>(&header), sizeof(Header));
+  file.write(reinterpret_cast<const char *>(coords.data()),
+             coords.size() * sizeof(double));
+  file.write(reinterpret_cast<const char *>(edges.data()),
+             edges.size() * sizeof(std::uint32_t));
+  file.write(reinterpret_cast<const char *>(cells.data()),
+             cells.size() * sizeof(std::uint32_t));
+  LF_VERIFY_MSG(file.good(), "Writing " + filename + " failed");
+}
+
+std::shared_ptr<lf::mesh::Mesh> ReadBinaryMesh(const std::string &filename,
+                                               std::uint64_t *stamp) {
+  return ReadBinaryMeshImpl(filename, nullptr, stamp);
+}
+
+std::shared_ptr<lf::mesh::Mesh> LoadMesh(const std::string &filename,
+                                         const std::string &cache_dir) {
+  namespace fs = std::filesystem;
+  ScopedTimer timer(Stage::kMeshLoading);
+  const fs::path path = fs::absolute(filename);
+  const std::uint64_t stamp = ModificationStamp(path);
+  {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    auto it = mesh_cache.find(path.string());
+    if (it != mesh_cache.end() && it->second.stamp == stamp) {
+      return it->second.mesh;
+    }
+  }
+
+  // Loading happens without the lock, so that different meshes can be
+  // loaded concurrently
+  std::shared_ptr<lf::mesh::Mesh> mesh_p;
+  fs::path binary_path;
+  if (!cache_dir.empty()) {
+    // Files of the same name in different directories get different cache
+    // files
+    const std::size_t path_hash =
+        std::hash<std::string>{}(fs::weakly_canonical(path).string());
+    std::ostringstream name;
+    name << path.filename().string() << '.' << std::hex << path_hash
+         << ".lfmb";
+    binary_path = fs::path(cache_dir) / name.str();
+    mesh_p = ReadBinaryMeshImpl(binary_path.string(), &stamp, nullptr);
+  }
+  if (mesh_p == nullptr) {
+    auto mesh_factory = std::make_unique<lf::mesh::hybrid2d::MeshFactory>(2);
+    lf::io::GmshReader reader(std::move(mesh_factory), path.string());
+    mesh_p = reader.mesh();
+    if (!cache_dir.empty()) {
+      // Write to a unique temporary file first, so that concurrent readers
+      // never see a partially written file
+      fs::create_directories(cache_dir);
+      const std::string tmp_path =
+          binary_path.string() + "." + std::to_string(getpid()) + "." +
+          std::to_string(std::hash<std::thread::id>{}(
+              std::this_thread::get_id()));
+      WriteBinaryMesh(*mesh_p, tmp_path, stamp);
+      fs::rename(tmp_path, binary_path);
+    }
+  }
+
+  Profiler::CountCells(Stage::kMeshLoading, mesh_p->NumEntities(0));
+  std::lock_guard<std::mutex> lock(cache_mutex);
+  mesh_cache[path.string()] = {stamp, mesh_p};
+  return mesh_p;
+}
+
+void ClearMeshCache() {
+  std::lock_guard<std::mutex> lock(cache_mutex);
+  mesh_cache.clear();
+}
+
+}  // namespace StableEvaluationAtAPoint
@@ -0,0 +1,63 @@
+#ifndef MESH_CACHE_H
+#define MESH_CACHE_H
+
+/**
+ * @file meshcache.h
+ * @brief NPDE homework StableEvaluationAtAPoint
+ * @author Amélie Loher, Erick Schulz & Philippe Peter
+ * @date 29.11.2021
+ * @copyright Developed at ETH Zurich
+ */
+
+#include <lf/mesh/mesh.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace StableEvaluationAtAPoint {
+
+/** @brief Writes a 2D mesh of triangles and quadrilaterals with straight
+ * edges in a compact binary format
+ *
+ * The file holds a header, the node coordinates and the node indices of all
+ * edges and cells, in host byte order. Reading it back reproduces the indices
+ * of all entities, cells get first order geometries. Physical groups of Gmsh
+ * files are not stored.
+ * @param stamp arbitrary number stored in the header, e.g. the modification
+ * time of the file the mesh was read from
+ */
+void WriteBinaryMesh(const lf::mesh::Mesh &mesh, const std::string &filename,
+                     std::uint64_t stamp = 0);
+
+/** @brief Reads a mesh written by WriteBinaryMesh() by mapping the file into
+ * memory
+ * @param stamp if not nullptr, receives the stamp stored in the header
+ * @return nullptr if the file does not exist or is not a valid mesh file
+ */
+std::shared_ptr<lf::mesh::Mesh> ReadBinaryMesh(const std::string &filename,
+                                               std::uint64_t *stamp = nullptr);
+
+/** @brief Loads a Gmsh mesh file, using a cache in memory and optionally a
+ * cache of binary mesh files on disk
+ *
+ * Meshes are kept in memory until ClearMeshCache() is called, keyed by the
+ * path and the modification time of the Gmsh file, so repeated calls return
+ * the same mesh object. Otherwise, if cache_dir is not empty, the binary file
+ * cache_dir/<file name>.<hash of the canonical path>.lfmb is read if it was
+ * written for the current modification time of the Gmsh file. Only if this
+ * fails is the Gmsh file parsed, and the binary file is (re)written.
+ */
+std::shared_ptr<lf::mesh::Mesh> LoadMesh(const std::string &filename,
+                                         const std::string &cache_dir = "");
+
+/** @brief Drops all meshes held by the memory cache of LoadMesh()
+ *
+ * Meshes still referenced elsewhere stay alive, later calls of LoadMesh()
+ * read the files again.
+ */
+void ClearMeshCache();
+
+}  // namespace StableEvaluationAtAPoint
+
+#endif  // MESH_CACHE_H
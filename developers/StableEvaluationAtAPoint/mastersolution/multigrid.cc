@@ -0,0 +1,199 @@
+/**
+ * @file multigrid.cc
+ * @brief NPDE homework StableEvaluationAtAPoint
+ * @author Amélie Loher, Erick Schulz & Philippe Peter
+ * @date 29.11.2021
+ * @copyright Developed at ETH Zurich
+ */
+
+#include "multigrid.h"
+
+#include <lf/assemble/assemble.h>
+#include <lf/base/base.h>
+#include <lf/mesh/utils/utils.h>
+
+#include <Eigen/Core>
+#include <Eigen/SparseCore>
+#include <utility>
+#include <vector>
+
+#include "gaussseidel.h"
+
+namespace StableEvaluationAtAPoint {
+
+namespace {
+
+using RowMatrix = Eigen::SparseMatrix<double, Eigen::RowMajor>;
+
+// Replaces the rows and columns of the flagged dofs by those of the identity
+RowMatrix EliminateDofs(const RowMatrix &A, const std::vector<bool> &flags) {
+  std::vector<Eigen::Triplet<double>> triplets;
+  triplets.reserve(A.nonZeros());
+  for (Eigen::Index i = 0; i < A.outerSize(); ++i) {
+    if (flags[i]) {
+      triplets.emplace_back(i, i, 1.0);
+      continue;
+    }
+    for (RowMatrix::InnerIterator it(A, i); it; ++it) {
+      if (!flags[it.col()]) {
+        triplets.emplace_back(i, it.col(), it.value());
+      }
+    }
+  }
+  RowMatrix A_elim(A.rows(), A.cols());
+  A_elim.setFromTriplets(triplets.begin(), triplets.end());
+  return A_elim;
+}
+
+}  // namespace
+
+MultigridHierarchy::MultigridHierarchy(
+    std::shared_ptr<const lf::refinement::MeshHierarchy> mh) {
+  const unsigned int L = static_cast<unsigned int>(mh->NumLevels());
+  levels_.resize(L);
+  for (unsigned int l = 0; l < L; ++l) {
+    Level &level = levels_[l];
+    std::shared_ptr<const lf::mesh::Mesh> mesh_p = mh->getMesh(l);
+    level.fe_space =
+        std::make_shared<lf::uscalfe::FeSpaceLagrangeO1<double>>(mesh_p);
+    const lf::assemble::DofHandler &dofh{level.fe_space->LocGlobMap()};
+    const lf::assemble::size_type N_dofs = dofh.NumDofs();
+
+    // Galerkin matrix of the Laplacian
+    lf::assemble::COOMatrix<double> A(N_dofs, N_dofs);
+    lf::uscalfe::LinearFELaplaceElementMatrix elmat_builder{};
+    lf::assemble::AssembleMatrixLocally(0, dofh, dofh, elmat_builder, A);
+    level.A_full = A.makeSparse();
+
+    // Dirichlet dofs are those located at boundary nodes
+    auto bd_flags{lf::mesh::utils::flagEntitiesOnBoundary(mesh_p, 2)};
+    level.boundary.assign(N_dofs, false);
+    for (const lf::mesh::Entity *node : mesh_p->Entities(2)) {
+      if (bd_flags(*node)) {
+        level.boundary[dofh.GlobalDofIndices(*node)[0]] = true;
+      }
+    }
+    level.A = EliminateDofs(level.A_full, level.boundary);
+
+    if (l == 0) {
+      coarse_solver_.compute(Eigen::SparseMatrix<double>(level.A));
+      LF_VERIFY_MSG(coarse_solver_.info() == Eigen::Success,
+                    "LDLT decomposition failed");
+      continue;
+    }
+
+    // Nodal interpolation from level l - 1: every node of the refined mesh
+    // is either a copy of a coarse node or the midpoint of a coarse edge
+    const Level &coarse = levels_[l - 1];
+    const lf::assemble::DofHandler &dofh_c{coarse.fe_space->LocGlobMap()};
+    const std::vector<lf::refinement::ParentInfo> &parents =
+        mh->ParentInfos(l, 2);
+    std::vector<Eigen::Triplet<double>> triplets;
+    std::vector<Eigen::Triplet<double>> triplets_0;
+    auto add = [&](Eigen::Index i, Eigen::Index j, double w) {
+      triplets.emplace_back(i, j, w);
+      if (!level.boundary[i] && !coarse.boundary[j]) {
+        triplets_0.emplace_back(i, j, w);
+      }
+    };
+    for (const lf::mesh::Entity *node : mesh_p->Entities(2)) {
+      const Eigen::Index i = dofh.GlobalDofIndices(*node)[0];
+      const lf::mesh::Entity *parent =
+          parents[mesh_p->Index(*node)].parent_ptr;
+      LF_VERIFY_MSG(parent != nullptr, "Node without parent entity");
+      if (parent->RefEl() == lf::base::RefEl::kPoint()) {
+        add(i, dofh_c.GlobalDofIndices(*parent)[0], 1.0);
+      } else {
+        LF_VERIFY_MSG(parent->RefEl() == lf::base::RefEl::kSegment(),
+                      "Nodes must be created on edges by regular refinement");
+        for (const lf::mesh::Entity *endpoint : parent->SubEntities(1)) {
+          add(i, dofh_c.GlobalDofIndices(*endpoint)[0], 0.5);
+        }
+      }
+    }
+    const Eigen::Index N_c = coarse.A.rows();
+    level.P_interp.resize(N_dofs, N_c);
+    level.P_interp.setFromTriplets(triplets.begin(), triplets.end());
+    // The coarse grid correction must not change the Dirichlet values
+    level.P.resize(N_dofs, N_c);
+    level.P.setFromTriplets(triplets_0.begin(), triplets_0.end());
+    level.R = level.P.transpose();
+  }
+}
+
+Eigen::VectorXd MultigridHierarchy::Prolongate(
+    unsigned int level, const Eigen::VectorXd &u_coarse) const {
+  return levels_[level].P_interp * u_coarse;
+}
+
+void MultigridHierarchy::VCycle(unsigned int l, const Eigen::VectorXd &b,
+                                Eigen::VectorXd &x) const {
+  const Level &level = levels_[l];
+  if (l == 0) {
+    x = coarse_solver_.solve(b);
+    return;
+  }
+  x.setZero(b.size());
+  GaussSeidel(level.A, b, x, true);
+  const Eigen::VectorXd r_coarse = level.R * (b - level.A * x);
+  Eigen::VectorXd x_coarse;
+  VCycle(l - 1, r_coarse, x_coarse);
+  x += level.P * x_coarse;
+  GaussSeidel(level.A, b, x, false);
+}
+
+void MultigridHierarchy::Solve(unsigned int level,
+                               const Eigen::VectorXd &g_vals,
+                               Eigen::VectorXd &x, double tol,
+                               SolverInfo *info,
+                               unsigned int max_cycles) const {
+  const Level &lev = levels_[level];
+  const Eigen::Index N_dofs = lev.A.rows();
+
+  // Right-hand side of the eliminated system, see FixFlaggedSolutionComponents
+  Eigen::VectorXd g_B = Eigen::VectorXd::Zero(N_dofs);
+  for (Eigen::Index i = 0; i < N_dofs; ++i) {
+    if (lev.boundary[i]) {
+      g_B[i] = g_vals[i];
+    }
+  }
+  Eigen::VectorXd b = -(lev.A_full * g_B);
+  for (Eigen::Index i = 0; i < N_dofs; ++i) {
+    if (lev.boundary[i]) {
+      b[i] = g_B[i];
+    }
+  }
+  if (x.size() != N_dofs) {
+    x.setZero(N_dofs);
+  }
+  for (Eigen::Index i = 0; i < N_dofs; ++i) {
+    if (lev.boundary[i]) {
+      x[i] = g_B[i];
+    }
+  }
+
+  const double b_norm = b.norm();
+  Eigen::VectorXd r = b - lev.A * x;
+  double residual = b_norm > 0.0 ? r.norm() / b_norm : r.norm();
+  unsigned int cycles = 0;
+  if (level == 0) {
+    x = coarse_solver_.solve(b);
+    r = b - lev.A * x;
+    residual = b_norm > 0.0 ? r.norm() / b_norm : r.norm();
+  }
+  Eigen::VectorXd e;
+  while (residual > tol && cycles < max_cycles) {
+    VCycle(level, r, e);
+    x += e;
+    r = b - lev.A * x;
+    residual = b_norm > 0.0 ? r.norm() / b_norm : r.norm();
+    ++cycles;
+  }
+  LF_VERIFY_MSG(residual <= tol, "Multigrid did not converge");
+  if (info != nullptr) {
+    info->iterations = cycles;
+    info->residual = residual;
+  }
+}
+
+}  // namespace StableEvaluationAtAPoint
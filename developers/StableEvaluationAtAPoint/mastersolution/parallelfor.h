@@ -0,0 +1,86 @@
+#ifndef PARALLEL_FOR_H
+#define PARALLEL_FOR_H
+
+/**
+ * @file parallelfor.h
+ * @brief NPDE homework StableEvaluationAtAPoint
+ * @author Amélie Loher, Erick Schulz & Philippe Peter
+ * @date 29.11.2021
+ * @copyright Developed at ETH Zurich
+ */
+
+#include <Eigen/Core>
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace StableEvaluationAtAPoint {
+
+/** @brief Calls body(begin, end) on a partition of [0, n) into contiguous
+ * blocks, one block per thread
+ * @param num_threads number of threads, 0 selects the number of hardware
+ * threads
+ */
+template <typename BODY>
+void ParallelFor(Eigen::Index n, unsigned int num_threads, BODY &&body) {
+  if (num_threads == 0) {
+    num_threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  const Eigen::Index N_blocks =
+      std::min<Eigen::Index>(num_threads, std::max<Eigen::Index>(n, 1));
+  if (N_blocks == 1) {
+    body(Eigen::Index(0), n);
+    return;
+  }
+  std::vector<std::thread> threads;
+  threads.reserve(N_blocks);
+  for (Eigen::Index b = 0; b < N_blocks; ++b) {
+    threads.emplace_back(body, n * b / N_blocks, n * (b + 1) / N_blocks);
+  }
+  for (std::thread &t : threads) {
+    t.join();
+  }
+}
+
+/** @brief Calls body(task) for every task in a list of independent tasks
+ *
+ * Every thread repeatedly takes the next task from the list until none is
+ * left, so the tasks are started in the given order. Listing expensive
+ * tasks first avoids that one of them is started last and determines the
+ * total run time.
+ * @param num_threads number of threads, 0 selects the number of hardware
+ * threads
+ */
+template <typename TASK, typename BODY>
+void ParallelForEachTask(const std::vector<TASK> &tasks,
+                         unsigned int num_threads, BODY &&body) {
+  if (num_threads == 0) {
+    num_threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  const std::size_t N_workers = std::min<std::size_t>(
+      num_threads, std::max<std::size_t>(tasks.size(), 1));
+  std::atomic<std::size_t> next{0};
+  auto worker = [&]() {
+    for (std::size_t t = next++; t < tasks.size(); t = next++) {
+      body(tasks[t]);
+    }
+  };
+  if (N_workers == 1) {
+    worker();
+    return;
+  }
+  std::vector<std::thread> threads;
+  threads.reserve(N_workers);
+  for (std::size_t w = 0; w < N_workers; ++w) {
+    threads.emplace_back(worker);
+  }
+  for (std::thread &t : threads) {
+    t.join();
+  }
+}
+
+}  // namespace StableEvaluationAtAPoint
+
+#endif  // PARALLEL_FOR_H
@@ -16,11 +16,16 @@ os.makedirs(output_folder, exist_ok=True)
 data = np.genfromtxt(input_file, delimiter=',', skip_header=1)
 h = data[:,0]
 error_potential = data[:,1]
+error_potential_gauss = data[:,2]
 h2 = np.square(h)
 h2 = 2.0*error_potential[-1]/h2[-1]*h2
+h4 = np.power(h, 4)
+h4 = 2.0*error_potential_gauss[-1]/h4[-1]*h4
 #Plot errors
 plt.loglog(h,error_potential, 'o-', markersize=5, label="Error in u(x) (Potential Method)")
 plt.loglog(h, h2,'--', label="O(h^2)" )
+plt.loglog(h,error_potential_gauss, 'o-', markersize=5, label="Error in u(x) (Potential Method, Gauss)")
+plt.loglog(h, h4,'--', label="O(h^4)" )
 #Label plot
 plt.legend()
 plt.xlabel('h')
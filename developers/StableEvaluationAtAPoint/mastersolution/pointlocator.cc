@@ -0,0 +1,106 @@
+/**
+ * @file pointlocator.cc
+ * @brief NPDE homework StableEvaluationAtAPoint
+ * @author Amélie Loher, Erick Schulz & Philippe Peter
+ * @date 29.11.2021
+ * @copyright Developed at ETH Zurich
+ */
+
+#include "pointlocator.h"
+
+#include <lf/base/base.h>
+#include <lf/mesh/mesh.h>
+
+#include <Eigen/Core>
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace StableEvaluationAtAPoint {
+
+PointLocator::PointLocator(std::shared_ptr<const lf::mesh::Mesh> mesh_p,
+                           double cells_per_bucket)
+    : mesh_p_(std::move(mesh_p)),
+      geometry_(GetTriangleGeometryTable(mesh_p_)) {
+  const lf::base::size_type N_cells = mesh_p_->NumEntities(0);
+  // Bounding boxes of the cells, lower corner in rows 0,1, upper in rows 2,3
+  Eigen::Matrix<double, 4, Eigen::Dynamic> boxes(4, N_cells);
+
+  for (unsigned int k = 0; k < N_cells; ++k) {
+    const Eigen::Matrix<double, 2, 3> corners = geometry_->Corners(k);
+    boxes.block<2, 1>(0, k) = corners.rowwise().minCoeff();
+    boxes.block<2, 1>(2, k) = corners.rowwise().maxCoeff();
+  }
+
+  // Uniform grid of roughly N_cells / cells_per_bucket buckets with nearly
+  // square buckets covering the bounding box of the mesh
+  lower_ = boxes.topRows<2>().rowwise().minCoeff();
+  const Eigen::Vector2d upper = boxes.bottomRows<2>().rowwise().maxCoeff();
+  const Eigen::Vector2d extent = (upper - lower_).cwiseMax(1.0E-14);
+  const double N_buckets = std::max(1.0, N_cells / cells_per_bucket);
+  const double bucket_size =
+      std::sqrt(extent.prod() / N_buckets) + 1.0E-14 * extent.maxCoeff();
+  nx_ = static_cast<unsigned int>(std::ceil(extent(0) / bucket_size));
+  ny_ = static_cast<unsigned int>(std::ceil(extent(1) / bucket_size));
+  nx_ = std::max(nx_, 1u);
+  ny_ = std::max(ny_, 1u);
+  inv_bucket_size_ << nx_ / extent(0), ny_ / extent(1);
+
+  // Distribute the cells to the buckets overlapped by their bounding boxes.
+  // The first pass counts, the second pass fills the CSR-like arrays.
+  const auto for_each_bucket = [this, &boxes](unsigned int k, auto &&action) {
+    const Eigen::Vector2d margin = 1.0E-12 * (boxes.block<2, 1>(2, k) -
+                                              boxes.block<2, 1>(0, k));
+    const unsigned int b_low =
+        BucketIndex(boxes.block<2, 1>(0, k) - margin);
+    const unsigned int b_up = BucketIndex(boxes.block<2, 1>(2, k) + margin);
+    for (unsigned int j = b_low / nx_; j <= b_up / nx_; ++j) {
+      for (unsigned int i = b_low % nx_; i <= b_up % nx_; ++i) {
+        action(j * nx_ + i);
+      }
+    }
+  };
+  bucket_offsets_.assign(nx_ * ny_ + 1, 0);
+  for (unsigned int k = 0; k < N_cells; ++k) {
+    for_each_bucket(k, [this](unsigned int b) { ++bucket_offsets_[b + 1]; });
+  }
+  for (unsigned int b = 0; b < nx_ * ny_; ++b) {
+    bucket_offsets_[b + 1] += bucket_offsets_[b];
+  }
+  bucket_cells_.resize(bucket_offsets_.back());
+  std::vector<unsigned int> fill(bucket_offsets_.begin(),
+                                 bucket_offsets_.end() - 1);
+  for (unsigned int k = 0; k < N_cells; ++k) {
+    for_each_bucket(k, [this, &fill, k](unsigned int b) {
+      bucket_cells_[fill[b]++] = k;
+    });
+  }
+}
+
+unsigned int PointLocator::BucketIndex(const Eigen::Vector2d &x) const {
+  const Eigen::Vector2d s = (x - lower_).cwiseProduct(inv_bucket_size_);
+  const auto clamp = [](double v, unsigned int n) -> unsigned int {
+    return v <= 0.0 ? 0u
+                    : std::min(static_cast<unsigned int>(v), n - 1);
+  };
+  return clamp(s(1), ny_) * nx_ + clamp(s(0), nx_);
+}
+
+std::pair<const lf::mesh::Entity *, Eigen::Vector2d> PointLocator::Locate(
+    const Eigen::Vector2d &global, double tol) const {
+  const unsigned int b = BucketIndex(global);
+  for (unsigned int l = bucket_offsets_[b]; l < bucket_offsets_[b + 1]; ++l) {
+    const unsigned int k = bucket_cells_[l];
+    // transform global coordinates to local coordinates on the cell
+    const Eigen::Vector2d loc = geometry_->Local(k, global);
+    // accept the cell, if local coordinates lie in the reference triangle
+    if (loc(0) >= 0 - tol && loc(1) >= 0 - tol && loc(0) + loc(1) <= 1 + tol) {
+      return {mesh_p_->EntityByIndex(0, k), loc};
+    }
+  }
+  return {nullptr, Eigen::Vector2d::Zero()};
+}
+
+}  // namespace StableEvaluationAtAPoint
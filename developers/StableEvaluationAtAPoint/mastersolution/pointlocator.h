@@ -0,0 +1,73 @@
+#ifndef POINT_LOCATOR_H
+#define POINT_LOCATOR_H
+
+/**
+ * @file pointlocator.h
+ * @brief NPDE homework StableEvaluationAtAPoint
+ * @author Amélie Loher, Erick Schulz & Philippe Peter
+ * @date 29.11.2021
+ * @copyright Developed at ETH Zurich
+ */
+
+#include <lf/mesh/mesh.h>
+
+#include <Eigen/Core>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "trianglegeometry.h"
+
+namespace StableEvaluationAtAPoint {
+
+/** @brief Spatial index answering "which cell contains x" for a triangular
+ * mesh.
+ *
+ * The bounding box of the mesh is covered by a uniform grid of buckets and
+ * every bucket stores the cells whose bounding boxes overlap it. For the
+ * quasi-uniform meshes used in this problem a bucket holds O(1) cells, so a
+ * query costs O(1) on average instead of O(N_cells) for a scan of the mesh.
+ * The inverse affine maps of the cells are taken from the
+ * TriangleGeometryTable of the mesh.
+ */
+class PointLocator {
+ public:
+  /** @brief Builds the bucket grid for the given mesh
+   * @param mesh_p mesh consisting of straight triangles only
+   * @param cells_per_bucket average number of cells assigned to a bucket
+   */
+  explicit PointLocator(std::shared_ptr<const lf::mesh::Mesh> mesh_p,
+                        double cells_per_bucket = 2.0);
+
+  /** @brief Finds a cell containing the point global
+   * @param global point given by its global coordinates
+   * @param tol tolerance for the inclusion test in local coordinates
+   * @return pointer to a cell containing global together with the local
+   * coordinates of global in this cell. The pointer is nullptr if global does
+   * not lie in the mesh.
+   */
+  std::pair<const lf::mesh::Entity *, Eigen::Vector2d> Locate(
+      const Eigen::Vector2d &global, double tol = 10E-10) const;
+
+  /** @brief The mesh the locator has been built for */
+  std::shared_ptr<const lf::mesh::Mesh> Mesh() const { return mesh_p_; }
+
+ private:
+  // Index of the bucket containing the point x (clamped to the grid)
+  unsigned int BucketIndex(const Eigen::Vector2d &x) const;
+
+  std::shared_ptr<const lf::mesh::Mesh> mesh_p_;
+  // Lower left corner of the grid and inverse widths of a bucket
+  Eigen::Vector2d lower_;
+  Eigen::Vector2d inv_bucket_size_;
+  unsigned int nx_, ny_;
+  // Cells of bucket b are stored in bucket_cells_ at the positions
+  // bucket_offsets_[b], ..., bucket_offsets_[b + 1] - 1
+  std::vector<unsigned int> bucket_offsets_;
+  std::vector<unsigned int> bucket_cells_;
+  std::shared_ptr<const TriangleGeometryTable> geometry_;
+};
+
+}  // namespace StableEvaluationAtAPoint
+
+#endif  // POINT_LOCATOR_H
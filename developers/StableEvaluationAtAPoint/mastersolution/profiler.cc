@@ -0,0 +1,116 @@
+/**
+ * @file profiler.cc
+ * @brief NPDE homework StableEvaluationAtAPoint
+ * @author Amélie Loher, Erick Schulz & Philippe Peter
+ * @date 29.11.2021
+ * @copyright Developed at ETH Zurich
+ */
+
+#include "profiler.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <ios>
+#include <ostream>
+
+namespace StableEvaluationAtAPoint {
+
+namespace {
+
+constexpr int kNumStages = static_cast<int>(Stage::kNumStages);
+constexpr int kNumCounters = 5;
+
+std::array<std::array<std::atomic<std::uint64_t>, kNumCounters>, kNumStages>
+    counters{};
+
+}  // namespace
+
+void Profiler::Reset() {
+  for (auto &stage_counters : counters) {
+    for (std::atomic<std::uint64_t> &c : stage_counters) {
+      c.store(0, std::memory_order_relaxed);
+    }
+  }
+}
+
+void Profiler::Add(Stage stage, Counter counter, std::uint64_t n) {
+  counters[static_cast<int>(stage)][counter].fetch_add(
+      n, std::memory_order_relaxed);
+}
+
+void Profiler::AddTime(Stage stage, std::chrono::nanoseconds time) {
+  Add(stage, kCalls, 1);
+  Add(stage, kNanoseconds, static_cast<std::uint64_t>(time.count()));
+}
+
+StageStats Profiler::Stats(Stage stage) {
+  const auto &c = counters[static_cast<int>(stage)];
+  StageStats stats;
+  stats.calls = c[kCalls].load(std::memory_order_relaxed);
+  stats.seconds = 1.0E-9 * c[kNanoseconds].load(std::memory_order_relaxed);
+  stats.cells = c[kCells].load(std::memory_order_relaxed);
+  stats.kernel_evaluations =
+      c[kKernelEvaluations].load(std::memory_order_relaxed);
+  stats.bytes = c[kBytes].load(std::memory_order_relaxed);
+  return stats;
+}
+
+const char *Profiler::Name(Stage stage) {
+  switch (stage) {
+    case Stage::kMeshLoading:
+      return "mesh loading";
+    case Stage::kAssembly:
+      return "assembly";
+    case Stage::kLinearSolve:
+      return "linear solve";
+    case Stage::kEvaluateFEFunction:
+      return "EvaluateFEFunction";
+    case Stage::kJstar:
+      return "Jstar";
+    case Stage::kPotentials:
+      return "potentials";
+    case Stage::kNumStages:
+      break;
+  }
+  return "";
+}
+
+void Profiler::PrintTable(std::ostream &out) {
+  const std::ios_base::fmtflags flags = out.flags();
+  const std::streamsize precision = out.precision();
+  out << std::left << std::setw(20) << "stage" << std::right << std::setw(8)
+      << "calls" << std::setw(12) << "time [s]" << std::setw(12) << "cells"
+      << std::setw(16) << "kernel evals" << std::setw(14) << "bytes"
+      << "\n";
+  for (int s = 0; s < kNumStages; ++s) {
+    const StageStats stats = Stats(static_cast<Stage>(s));
+    out << std::left << std::setw(20) << Name(static_cast<Stage>(s))
+        << std::right << std::setw(8) << stats.calls << std::setw(12)
+        << std::fixed << std::setprecision(4) << stats.seconds
+        << std::defaultfloat << std::setw(12) << stats.cells << std::setw(16)
+        << stats.kernel_evaluations << std::setw(14) << stats.bytes << "\n";
+  }
+  out.flags(flags);
+  out.precision(precision);
+}
+
+void Profiler::PrintJSON(std::ostream &out) {
+  const std::streamsize precision = out.precision();
+  out << "{\n";
+  for (int s = 0; s < kNumStages; ++s) {
+    const StageStats stats = Stats(static_cast<Stage>(s));
+    out << "  \"" << Name(static_cast<Stage>(s)) << "\": {\"calls\": "
+        << stats.calls << ", \"seconds\": " << std::setprecision(9)
+        << stats.seconds << ", \"cells\": " << stats.cells
+        << ", \"kernel_evaluations\": " << stats.kernel_evaluations
+        << ", \"bytes\": " << stats.bytes << "}"
+        << (s + 1 < kNumStages ? ",\n" : "\n");
+  }
+  out << "}\n";
+  out.precision(precision);
+}
+
+}  // namespace StableEvaluationAtAPoint
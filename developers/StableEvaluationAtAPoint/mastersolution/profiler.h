@@ -0,0 +1,122 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+/**
+ * @file profiler.h
+ * @brief NPDE homework StableEvaluationAtAPoint
+ * @author Amélie Loher, Erick Schulz & Philippe Peter
+ * @date 29.11.2021
+ * @copyright Developed at ETH Zurich
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+namespace StableEvaluationAtAPoint {
+
+/** @brief Stages of the computations whose cost is recorded by Profiler */
+enum class Stage {
+  kMeshLoading,
+  kAssembly,
+  kLinearSolve,
+  kEvaluateFEFunction,
+  kJstar,
+  kPotentials,
+  kNumStages
+};
+
+/** @brief Statistics of one stage, summed over all calls and threads */
+struct StageStats {
+  std::uint64_t calls = 0;
+  double seconds = 0.0;
+  // Mesh cells processed
+  std::uint64_t cells = 0;
+  // Evaluations of the fundamental solution or its gradient
+  std::uint64_t kernel_evaluations = 0;
+  // Size of the main arrays allocated, e.g. the Galerkin matrix
+  std::uint64_t bytes = 0;
+};
+
+/** @brief Process-wide wall time and counters per Stage
+ *
+ * Recording is off by default. Then every ScopedTimer and every call of
+ * Count() only loads one atomic flag, so the instrumented functions run at
+ * full speed. When enabled, the statistics are accumulated with atomic
+ * additions and may be recorded from several threads. The wall times of
+ * concurrent calls add up, so they can exceed the elapsed time.
+ */
+class Profiler {
+ public:
+  static void Enable(bool enable = true) {
+    enabled_.store(enable, std::memory_order_relaxed);
+  }
+  static bool Enabled() { return enabled_.load(std::memory_order_relaxed); }
+  /** @brief Sets all statistics to zero */
+  static void Reset();
+
+  static void AddTime(Stage stage, std::chrono::nanoseconds time);
+  static void CountCells(Stage stage, std::uint64_t n) {
+    if (Enabled()) {
+      Add(stage, kCells, n);
+    }
+  }
+  static void CountKernelEvaluations(Stage stage, std::uint64_t n) {
+    if (Enabled()) {
+      Add(stage, kKernelEvaluations, n);
+    }
+  }
+  static void CountBytes(Stage stage, std::uint64_t n) {
+    if (Enabled()) {
+      Add(stage, kBytes, n);
+    }
+  }
+
+  static StageStats Stats(Stage stage);
+  static const char *Name(Stage stage);
+
+  /** @brief Writes a table with one line per stage */
+  static void PrintTable(std::ostream &out);
+  /** @brief Writes the statistics as a JSON object with one member per
+   * stage */
+  static void PrintJSON(std::ostream &out);
+
+ private:
+  enum Counter { kCalls, kNanoseconds, kCells, kKernelEvaluations, kBytes };
+  static void Add(Stage stage, Counter counter, std::uint64_t n);
+
+  inline static std::atomic<bool> enabled_{false};
+};
+
+/** @brief Adds the wall time from its construction until Stop() or its
+ * destruction to a stage, if the Profiler is enabled at construction
+ */
+class ScopedTimer {
+ public:
+  explicit ScopedTimer(Stage stage)
+      : stage_(stage), running_(Profiler::Enabled()) {
+    if (running_) {
+      start_ = std::chrono::steady_clock::now();
+    }
+  }
+  ~ScopedTimer() { Stop(); }
+  ScopedTimer(const ScopedTimer &) = delete;
+  ScopedTimer &operator=(const ScopedTimer &) = delete;
+
+  void Stop() {
+    if (running_) {
+      Profiler::AddTime(stage_, std::chrono::steady_clock::now() - start_);
+      running_ = false;
+    }
+  }
+
+ private:
+  Stage stage_;
+  bool running_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+}  // namespace StableEvaluationAtAPoint
+
+#endif  // PROFILER_H
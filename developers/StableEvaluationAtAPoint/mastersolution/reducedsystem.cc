@@ -0,0 +1,90 @@
+/**
+ * @file reducedsystem.cc
+ * @brief NPDE homework StableEvaluationAtAPoint
+ * @author Amélie Loher, Erick Schulz & Philippe Peter
+ * @date 29.11.2021
+ * @copyright Developed at ETH Zurich
+ */
+
+#include "reducedsystem.h"
+
+#include <lf/base/base.h>
+
+#include <Eigen/Core>
+#include <Eigen/SparseCore>
+#include <vector>
+
+namespace StableEvaluationAtAPoint {
+
+ReducedSystem::ReducedSystem(const Eigen::SparseMatrix<double> &A,
+                             const std::vector<bool> &is_dirichlet)
+    : is_dirichlet_(is_dirichlet) {
+  const Eigen::Index N = A.rows();
+  LF_ASSERT_MSG(Eigen::Index(is_dirichlet.size()) == N, "Size mismatch");
+
+  // Position of every dof within its block
+  std::vector<Eigen::Index> block_index(N);
+  for (Eigen::Index i = 0; i < N; ++i) {
+    std::vector<Eigen::Index> &block = is_dirichlet[i] ? dirichlet_ : interior_;
+    block_index[i] = Eigen::Index(block.size());
+    block.push_back(i);
+  }
+
+  // Columns are visited in ascending order, so the blocks can be filled
+  // column by column
+  const Eigen::Index N_I = interior_.size();
+  const Eigen::Index N_B = dirichlet_.size();
+  A_II_.resize(N_I, N_I);
+  A_IB_.resize(N_I, N_B);
+  Eigen::VectorXi nnz_II = Eigen::VectorXi::Zero(N_I);
+  Eigen::VectorXi nnz_IB = Eigen::VectorXi::Zero(N_B);
+  for (Eigen::Index j = 0; j < A.outerSize(); ++j) {
+    for (Eigen::SparseMatrix<double>::InnerIterator it(A, j); it; ++it) {
+      if (!is_dirichlet[it.row()]) {
+        ++(is_dirichlet[j] ? nnz_IB[block_index[j]] : nnz_II[block_index[j]]);
+      }
+    }
+  }
+  A_II_.reserve(nnz_II);
+  A_IB_.reserve(nnz_IB);
+  for (Eigen::Index j = 0; j < A.outerSize(); ++j) {
+    Eigen::SparseMatrix<double> &block = is_dirichlet[j] ? A_IB_ : A_II_;
+    for (Eigen::SparseMatrix<double>::InnerIterator it(A, j); it; ++it) {
+      if (!is_dirichlet[it.row()]) {
+        block.insert(block_index[it.row()], block_index[j]) = it.value();
+      }
+    }
+  }
+  A_II_.makeCompressed();
+  A_IB_.makeCompressed();
+}
+
+Eigen::MatrixXd ReducedSystem::Restrict(const Eigen::MatrixXd &X) const {
+  Eigen::MatrixXd X_I(interior_.size(), X.cols());
+  for (Eigen::Index k = 0; k < NumInterior(); ++k) {
+    X_I.row(k) = X.row(interior_[k]);
+  }
+  return X_I;
+}
+
+Eigen::MatrixXd ReducedSystem::Lifting(const Eigen::MatrixXd &G) const {
+  Eigen::MatrixXd G_B(dirichlet_.size(), G.cols());
+  for (Eigen::Index k = 0; k < Eigen::Index(dirichlet_.size()); ++k) {
+    G_B.row(k) = G.row(dirichlet_[k]);
+  }
+  return A_IB_ * G_B;
+}
+
+Eigen::MatrixXd ReducedSystem::Expand(const Eigen::MatrixXd &U_I,
+                                      const Eigen::MatrixXd &G) const {
+  Eigen::MatrixXd U(NumDofs(), G.cols());
+  for (Eigen::Index k = 0; k < NumInterior(); ++k) {
+    U.row(interior_[k]) = U_I.row(k);
+  }
+  for (Eigen::Index i : dirichlet_) {
+    U.row(i) = G.row(i);
+  }
+  return U;
+}
+
+}  // namespace StableEvaluationAtAPoint
@@ -0,0 +1,66 @@
+#ifndef REDUCED_SYSTEM_H
+#define REDUCED_SYSTEM_H
+
+/**
+ * @file reducedsystem.h
+ * @brief NPDE homework StableEvaluationAtAPoint
+ * @author Amélie Loher, Erick Schulz & Philippe Peter
+ * @date 29.11.2021
+ * @copyright Developed at ETH Zurich
+ */
+
+#include <Eigen/Core>
+#include <Eigen/SparseCore>
+#include <vector>
+
+namespace StableEvaluationAtAPoint {
+
+/** @brief Linear system for the interior dofs obtained by eliminating the
+ * Dirichlet dofs
+ *
+ * The Galerkin matrix is split into blocks A_II, A_IB of interior (I) and
+ * Dirichlet (B) dofs. With u_B = g_B, the interior values solve
+ *    A_II u_I = phi_I - A_IB g_B,
+ * where A_IB g_B is the lifting of the Dirichlet data. Unlike
+ * lf::assemble::FixFlaggedSolutionComponents() the Dirichlet dofs are
+ * removed, so the matrix is smaller. For the Laplacian A_II is s.p.d.,
+ * hence Cholesky and CG apply. Only A_II and A_IB are stored.
+ */
+class ReducedSystem {
+ public:
+  ReducedSystem() = default;
+  /** @brief Splits the full Galerkin matrix A
+   * @param is_dirichlet flags the Dirichlet dofs
+   */
+  ReducedSystem(const Eigen::SparseMatrix<double> &A,
+                const std::vector<bool> &is_dirichlet);
+
+  Eigen::Index NumDofs() const { return Eigen::Index(is_dirichlet_.size()); }
+  Eigen::Index NumInterior() const { return Eigen::Index(interior_.size()); }
+  /** @brief Matrix A_II of the interior system */
+  const Eigen::SparseMatrix<double> &Matrix() const { return A_II_; }
+
+  /** @brief Interior rows of X */
+  Eigen::MatrixXd Restrict(const Eigen::MatrixXd &X) const;
+  /** @brief Lifting A_IB g_B of the Dirichlet values in the columns of G,
+   * which hold full vectors of dof values
+   */
+  Eigen::MatrixXd Lifting(const Eigen::MatrixXd &G) const;
+  /** @brief Full vectors of dof values with interior values from the columns
+   * of U_I and Dirichlet values from the columns of G
+   */
+  Eigen::MatrixXd Expand(const Eigen::MatrixXd &U_I,
+                         const Eigen::MatrixXd &G) const;
+
+ private:
+  std::vector<bool> is_dirichlet_;
+  // Indices of the interior and Dirichlet dofs in ascending order
+  std::vector<Eigen::Index> interior_;
+  std::vector<Eigen::Index> dirichlet_;
+  Eigen::SparseMatrix<double> A_II_;
+  Eigen::SparseMatrix<double> A_IB_;
+};
+
+}  // namespace StableEvaluationAtAPoint
+
+#endif  // REDUCED_SYSTEM_H
@@ -8,6 +8,7 @@
 
 #include "stableevaluationatapoint.h"
 
+#include <lf/assemble/assemble.h>
 #include <lf/base/base.h>
 #include <lf/fe/fe.h>
 #include <lf/geometry/geometry.h>
@@ -16,14 +17,28 @@
 #include <lf/uscalfe/uscalfe.h>
 
 #include <Eigen/Core>
+#include <Eigen/LU>
 #include <algorithm>
+#include <array>
 #include <cmath>
+#include <cstdint>
+#include <functional>
 #include <iostream>
 #include <memory>
+#include <utility>
+#include <vector>
+
+#include "boundarytreecode.h"
+#include "parallelfor.h"
+#include "profiler.h"
 
 namespace StableEvaluationAtAPoint {
 
 double MeshSize(const std::shared_ptr<const lf::mesh::Mesh> &mesh_p) {
+  if (IsAffineTriangleMesh(*mesh_p)) {
+    // Maximal edge length, from the edge vectors of the cells
+    return GetTriangleGeometryTable(mesh_p)->MaxEdgeLength();
+  }
   double mesh_size = 0.0;
   // Find maximal edge length
   for (const lf::mesh::Entity *edge : mesh_p->Entities(1)) {
@@ -60,6 +75,20 @@ Eigen::Vector2d FundamentalSolution::grad(Eigen::Vector2d y) {
 
 double PointEval(std::shared_ptr<const lf::mesh::Mesh> mesh_p) {
   double error = 0.0;
+#if SOLUTION
+  error = PointEval(mesh_p,
+                    lf::quad::make_QuadRule(lf::base::RefEl::kSegment(), 1));
+#else
+  //====================
+  // Your code goes here
+  //====================
+#endif
+  return error;
+}
+
+double PointEval(std::shared_ptr<const lf::mesh::Mesh> mesh_p,
+                 const lf::quad::QuadRule &qr) {
+  double error = 0.0;
 #if SOLUTION
   const auto u = [](Eigen::Vector2d x) -> double {
     Eigen::Vector2d one(1.0, 0.0);
@@ -78,7 +107,9 @@ double PointEval(std::shared_ptr<const lf::mesh::Mesh> mesh_p) {
 
   // Compute right hand side
   const Eigen::Vector2d x(0.3, 0.4);
-  const double rhs = PSL(mesh_p, gradu_dot_n, x) - PDL(mesh_p, u, x);
+  // Plain rule on every edge, without near-field refinement
+  const BoundaryQuadratureCache cache(mesh_p, qr, 0.0);
+  const double rhs = PSL(cache, gradu_dot_n, x) - PDL(cache, u, x);
   // Compute the error
   error = std::abs(u(x) - rhs);
 #else
@@ -89,6 +120,86 @@ double PointEval(std::shared_ptr<const lf::mesh::Mesh> mesh_p) {
   return error;
 }
 
+Eigen::VectorXd PSLMultiValues(const BoundaryQuadratureCache &cache,
+                               const Eigen::VectorXd &v_vals,
+                               const Eigen::Matrix2Xd &xs,
+                               unsigned int num_threads, double treecode_tol) {
+  LF_ASSERT_MSG(v_vals.size() == cache.NumPoints(),
+                "One density value per quadrature point required");
+  ScopedTimer timer(Stage::kPotentials);
+  if (treecode_tol > 0.0) {
+    return BoundaryTreecode(cache, treecode_tol)
+        .SingleLayer(v_vals, xs, num_threads);
+  }
+  Eigen::VectorXd vals = Eigen::VectorXd::Zero(xs.cols());
+#if SOLUTION
+  Profiler::CountKernelEvaluations(Stage::kPotentials,
+                                   cache.NumPoints() * xs.cols());
+  // With r^2 = |x - y|^2 we have G_x(y) = -log(r^2) / (4 pi). The quadrature
+  // points are copied into separate coordinate arrays, so that the sums over
+  // the boundary are array expressions Eigen evaluates with vectorised log.
+  const Eigen::ArrayXd p0 = cache.Points().row(0).transpose();
+  const Eigen::ArrayXd p1 = cache.Points().row(1).transpose();
+  const Eigen::ArrayXd wv = v_vals.array() * cache.Weights().array();
+
+  ParallelFor(xs.cols(), num_threads, [&](Eigen::Index begin,
+                                          Eigen::Index end) {
+    Eigen::ArrayXd r2(p0.size());
+    for (Eigen::Index i = begin; i < end; ++i) {
+      r2 = (xs(0, i) - p0).square() + (xs(1, i) - p1).square();
+      vals[i] = -(wv * r2.log()).sum() / (4.0 * M_PI);
+    }
+  });
+#else
+  //====================
+  // Your code goes here
+  //====================
+#endif
+  return vals;
+}
+
+Eigen::VectorXd PDLMultiValues(const BoundaryQuadratureCache &cache,
+                               const Eigen::VectorXd &v_vals,
+                               const Eigen::Matrix2Xd &xs,
+                               unsigned int num_threads, double treecode_tol) {
+  LF_ASSERT_MSG(v_vals.size() == cache.NumPoints(),
+                "One density value per quadrature point required");
+  ScopedTimer timer(Stage::kPotentials);
+  if (treecode_tol > 0.0) {
+    return BoundaryTreecode(cache, treecode_tol)
+        .DoubleLayer(v_vals, xs, num_threads);
+  }
+  Eigen::VectorXd vals = Eigen::VectorXd::Zero(xs.cols());
+#if SOLUTION
+  Profiler::CountKernelEvaluations(Stage::kPotentials,
+                                   cache.NumPoints() * xs.cols());
+  // With r^2 = |x - y|^2 we have grad G_x(y) . n = (x - y) . n / (2 pi r^2),
+  // summed over the boundary as an array expression like in PSLMultiValues()
+  const Eigen::ArrayXd p0 = cache.Points().row(0).transpose();
+  const Eigen::ArrayXd p1 = cache.Points().row(1).transpose();
+  const Eigen::ArrayXd wv = v_vals.array() * cache.Weights().array();
+  const Eigen::ArrayXd wn0 = wv * cache.Normals().row(0).transpose().array();
+  const Eigen::ArrayXd wn1 = wv * cache.Normals().row(1).transpose().array();
+
+  ParallelFor(xs.cols(), num_threads, [&](Eigen::Index begin,
+                                          Eigen::Index end) {
+    Eigen::ArrayXd d0(p0.size());
+    Eigen::ArrayXd d1(p0.size());
+    for (Eigen::Index i = begin; i < end; ++i) {
+      d0 = xs(0, i) - p0;
+      d1 = xs(1, i) - p1;
+      vals[i] = ((d0 * wn0 + d1 * wn1) / (d0.square() + d1.square())).sum() /
+                (2.0 * M_PI);
+    }
+  });
+#else
+  //====================
+  // Your code goes here
+  //====================
+#endif
+  return vals;
+}
+
 double Psi::operator()(Eigen::Vector2d y) {
   const double c = M_PI / (0.5 * std::sqrt(2) - 1.0);
   const double dist = (y - center_).norm();
@@ -134,17 +245,90 @@ double Psi::lapl(Eigen::Vector2d y) {
   }
 }
 
+bool MeetsTransitionZone(const lf::mesh::Entity &cell, const Psi &psi) {
+  LF_ASSERT_MSG(lf::base::RefEl::kTria() == cell.RefEl(),
+                "Function only defined for triangular cells");
+  return MeetsTransitionZone(
+      Eigen::Matrix<double, 2, 3>(lf::geometry::Corners(*cell.Geometry())),
+      psi);
+}
+
+bool MeetsTransitionZone(const Eigen::Matrix<double, 2, 3> &corners,
+                         const Psi &psi) {
+  const Eigen::Vector2d c = psi.Center();
+  // Safety margin against round-off in the distances computed by Psi
+  const double r_in = Psi::InnerRadius() * (1.0 - 1.0E-12);
+  const double r_out = Psi::OuterRadius() * (1.0 + 1.0E-12);
+
+  // The distances of the points of the (convex) cell to c fill an interval
+  // [d_min, d_max]. The maximum is attained at a corner.
+  const Eigen::Array3d dist = (corners.colwise() - c).colwise().norm();
+  if (dist.maxCoeff() <= r_in) {
+    return false;
+  }
+  if (dist.minCoeff() < r_out) {
+    return true;
+  }
+  // All corners lie beyond the annulus: the cell meets it only if it
+  // contains c or one of its edges comes closer to c than r_out
+  Eigen::Matrix2d J;
+  J << corners.col(1) - corners.col(0), corners.col(2) - corners.col(0);
+  const Eigen::Vector2d loc = J.fullPivLu().solve(c - corners.col(0));
+  if (loc(0) >= 0.0 && loc(1) >= 0.0 && loc(0) + loc(1) <= 1.0) {
+    return true;
+  }
+  for (int i = 0; i < 3; ++i) {
+    const Eigen::Vector2d a = corners.col(i);
+    const Eigen::Vector2d e = corners.col((i + 1) % 3) - a;
+    const double t = std::clamp((c - a).dot(e) / e.squaredNorm(), 0.0, 1.0);
+    if ((a + t * e - c).norm() < r_out) {
+      return true;
+    }
+  }
+  return false;
+}
+
+std::vector<const lf::mesh::Entity *> TransitionZoneCells(
+    const std::shared_ptr<const lf::mesh::Mesh> &mesh_p, const Psi &psi) {
+  const std::shared_ptr<const TriangleGeometryTable> geometry =
+      GetTriangleGeometryTable(mesh_p);
+  std::vector<const lf::mesh::Entity *> cells;
+  for (Eigen::Index k = 0; k < geometry->NumCells(); ++k) {
+    if (MeetsTransitionZone(geometry->Corners(k), psi)) {
+      cells.push_back(mesh_p->EntityByIndex(0, k));
+    }
+  }
+  return cells;
+}
+
 double Jstar(std::shared_ptr<lf::uscalfe::FeSpaceLagrangeO1<double>> fe_space,
              Eigen::VectorXd uFE, const Eigen::Vector2d x) {
+  // The integrand vanishes outside the annulus where Psi is not constant
+  Psi psi(Eigen::Vector2d(0.5, 0.5));
+  return Jstar(fe_space, uFE, x, TransitionZoneCells(fe_space->Mesh(), psi));
+}
+
+double Jstar(std::shared_ptr<lf::uscalfe::FeSpaceLagrangeO1<double>> fe_space,
+             const Eigen::VectorXd &uFE, const Eigen::Vector2d x,
+             const lf::quad::QuadRule &qr) {
+  Psi psi(Eigen::Vector2d(0.5, 0.5));
+  return Jstar(fe_space, uFE, x, TransitionZoneCells(fe_space->Mesh(), psi),
+               qr);
+}
+
+double Jstar(std::shared_ptr<lf::uscalfe::FeSpaceLagrangeO1<double>> fe_space,
+             const Eigen::VectorXd &uFE, const Eigen::Vector2d x,
+             const std::vector<const lf::mesh::Entity *> &cells,
+             const lf::quad::QuadRule &qr) {
+  ScopedTimer timer(Stage::kJstar);
+  Profiler::CountCells(Stage::kJstar, cells.size());
+  Profiler::CountKernelEvaluations(Stage::kJstar,
+                                   2 * cells.size() * qr.NumPoints());
   double val = 0.0;
   Psi psi(Eigen::Vector2d(0.5, 0.5));
   FundamentalSolution G(x);
 #if SOLUTION
 
-  // Mesh covering a unit square domain
-  std::shared_ptr<const lf::mesh::Mesh> mesh = fe_space->Mesh();
-  // Use midpoint quadrature rule
-  const lf::quad::QuadRule qr = lf::quad::make_TriaQR_MidpointRule();
   // Quadrature points
   const Eigen::MatrixXd zeta_ref{qr.Points()};
   // Quadrature weights
@@ -153,23 +337,27 @@ double Jstar(std::shared_ptr<lf::uscalfe::FeSpaceLagrangeO1<double>> fe_space,
   const lf::base::size_type P = qr.NumPoints();
   // Create mesh function to be evaluated at the quadrature points
   auto uFE_mf = lf::fe::MeshFunctionFE(fe_space, uFE);
+  // Affine maps of the cells, read without calls of the Geometry interface
+  std::shared_ptr<const lf::mesh::Mesh> mesh_p = fe_space->Mesh();
+  const std::shared_ptr<const TriangleGeometryTable> geometry =
+      GetTriangleGeometryTable(mesh_p);
 
-  // Loop over all cells
-  for (const lf::mesh::Entity *entity : mesh->Entities(0)) {
-    // Standard way to apply a local quadrature rule
-    const lf::geometry::Geometry &geo{*entity->Geometry()};
-    // Quadrature points on actual cell
-    const Eigen::MatrixXd zeta{geo.Global(zeta_ref)};
-    const Eigen::VectorXd gram_dets{geo.IntegrationElement(zeta_ref)};
+  // Loop over the given cells
+  for (const lf::mesh::Entity *entity : cells) {
+    const lf::base::glb_idx_t k = mesh_p->Index(*entity);
+    // The Gramian determinant is constant on a straight triangle
+    const double gram_det = geometry->IntegrationElement(k);
     // Values of finite element function on all quadrature points
     auto u_vals = uFE_mf(*entity, zeta_ref);
 
     // Quadrature loop
     for (int l = 0; l < P; l++) {
-      const double w = w_ref[l] * gram_dets[l];
+      // Quadrature point on actual cell
+      const Eigen::Vector2d zeta = geometry->Global(k, zeta_ref.col(l));
+      const double w = w_ref[l] * gram_det;
       val += w * (-u_vals[l]) *
-             (2.0 * (G.grad(zeta.col(l))).dot(psi.grad(zeta.col(l))) +
-              G(zeta.col(l)) * psi.lapl(zeta.col(l)));
+             (2.0 * (G.grad(zeta)).dot(psi.grad(zeta)) +
+              G(zeta) * psi.lapl(zeta));
     }
   }
 #else
@@ -180,6 +368,279 @@ double Jstar(std::shared_ptr<lf::uscalfe::FeSpaceLagrangeO1<double>> fe_space,
   return val;
 }
 
+double JstarAdaptive(
+    std::shared_ptr<lf::uscalfe::FeSpaceLagrangeO1<double>> fe_space,
+    const Eigen::VectorXd &uFE, const Eigen::Vector2d x, double tol,
+    const lf::quad::QuadRule &qr, unsigned int max_depth) {
+  ScopedTimer timer(Stage::kJstar);
+  double val = 0.0;
+#if SOLUTION
+  Psi psi(Eigen::Vector2d(0.5, 0.5));
+  FundamentalSolution G(x);
+  auto uFE_mf = lf::fe::MeshFunctionFE(fe_space, uFE);
+  auto grad_uFE_mf = lf::fe::MeshFunctionGradFE(fe_space, uFE);
+  std::shared_ptr<const lf::mesh::Mesh> mesh_p = fe_space->Mesh();
+  const std::shared_ptr<const TriangleGeometryTable> geometry =
+      GetTriangleGeometryTable(mesh_p);
+  const std::vector<const lf::mesh::Entity *> cells =
+      TransitionZoneCells(mesh_p, psi);
+  Profiler::CountCells(Stage::kJstar, cells.size());
+
+  // The tolerance is distributed over the cells proportionally to area
+  double total_area = 0.0;
+  for (const lf::mesh::Entity *cell : cells) {
+    total_area += geometry->Volume(mesh_p->Index(*cell));
+  }
+
+  // Applies qr on the subtriangle of the reference triangle with corners
+  // given by the columns of sub, mapped to the cell
+  const auto integrate = [&](const lf::mesh::Entity &cell,
+                             const Eigen::Matrix<double, 2, 3> &sub) {
+    Eigen::Matrix2d B;
+    B << sub.col(1) - sub.col(0), sub.col(2) - sub.col(0);
+    const Eigen::MatrixXd loc = (B * qr.Points()).colwise() + sub.col(0);
+    const lf::base::glb_idx_t k = mesh_p->Index(cell);
+    const double gram_det =
+        std::abs(B.determinant()) * geometry->IntegrationElement(k);
+    auto u_vals = uFE_mf(cell, loc);
+    auto grad_u_vals = grad_uFE_mf(cell, loc);
+    Profiler::CountKernelEvaluations(Stage::kJstar, 2 * qr.NumPoints());
+    double sum = 0.0;
+    for (lf::base::size_type l = 0; l < qr.NumPoints(); ++l) {
+      const Eigen::Vector2d zeta = geometry->Global(k, loc.col(l));
+      const double w = qr.Weights()[l] * gram_det;
+      sum += w * (G(zeta) * grad_u_vals[l] - u_vals[l] * G.grad(zeta))
+                     .dot(psi.grad(zeta));
+    }
+    return sum;
+  };
+
+  // Recursive regular refinement of the subtriangle sub of the cell, where
+  // coarse is the value obtained by qr on sub and area the area of the image
+  // of sub
+  std::function<double(const lf::mesh::Entity &,
+                       const Eigen::Matrix<double, 2, 3> &, double, double,
+                       unsigned int)>
+      refine = [&](const lf::mesh::Entity &cell,
+                   const Eigen::Matrix<double, 2, 3> &sub, double coarse,
+                   double area, unsigned int depth) -> double {
+    const Eigen::Vector2d m01 = 0.5 * (sub.col(0) + sub.col(1));
+    const Eigen::Vector2d m12 = 0.5 * (sub.col(1) + sub.col(2));
+    const Eigen::Vector2d m20 = 0.5 * (sub.col(2) + sub.col(0));
+    std::array<Eigen::Matrix<double, 2, 3>, 4> children;
+    children[0] << sub.col(0), m01, m20;
+    children[1] << m01, sub.col(1), m12;
+    children[2] << m20, m12, sub.col(2);
+    children[3] << m12, m20, m01;
+    std::array<double, 4> fine;
+    double fine_sum = 0.0;
+    for (int i = 0; i < 4; ++i) {
+      fine[i] = integrate(cell, children[i]);
+      fine_sum += fine[i];
+    }
+    if (depth >= max_depth ||
+        std::abs(fine_sum - coarse) <= tol * area / total_area) {
+      return fine_sum;
+    }
+    double sum = 0.0;
+    for (int i = 0; i < 4; ++i) {
+      sum += refine(cell, children[i], fine[i], 0.25 * area, depth + 1);
+    }
+    return sum;
+  };
+
+  Eigen::Matrix<double, 2, 3> ref_tria;
+  ref_tria << 0.0, 1.0, 0.0, 0.0, 0.0, 1.0;
+  for (const lf::mesh::Entity *cell : cells) {
+    val += refine(*cell, ref_tria, integrate(*cell, ref_tria),
+                  geometry->Volume(mesh_p->Index(*cell)), 1);
+  }
+#else
+  //====================
+  // Your code goes here
+  //====================
+#endif
+  return val;
+}
+
+Eigen::VectorXd JstarMulti(
+    std::shared_ptr<lf::uscalfe::FeSpaceLagrangeO1<double>> fe_space,
+    const Eigen::VectorXd &uFE, const Eigen::Matrix2Xd &xs,
+    const lf::quad::QuadRule &qr, unsigned int num_threads) {
+  ScopedTimer timer(Stage::kJstar);
+  Eigen::VectorXd vals = Eigen::VectorXd::Zero(xs.cols());
+#if SOLUTION
+  Psi psi(Eigen::Vector2d(0.5, 0.5));
+  std::shared_ptr<const lf::mesh::Mesh> mesh = fe_space->Mesh();
+  const std::shared_ptr<const TriangleGeometryTable> geometry =
+      GetTriangleGeometryTable(mesh);
+  const Eigen::MatrixXd zeta_ref{qr.Points()};
+  const Eigen::VectorXd w_ref{qr.Weights()};
+  const lf::base::size_type P = qr.NumPoints();
+  auto uFE_mf = lf::fe::MeshFunctionFE(fe_space, uFE);
+
+  // Single pass over the cells meeting the support of the derivatives of Psi:
+  // gather the coordinates of the quadrature points and the weighted values
+  // -w*u_h*grad Psi and w*u_h*lapl Psi/4 in flat arrays
+  const std::vector<const lf::mesh::Entity *> cells =
+      TransitionZoneCells(mesh, psi);
+  const Eigen::Index N_qp = cells.size() * P;
+  Profiler::CountCells(Stage::kJstar, cells.size());
+  Profiler::CountKernelEvaluations(Stage::kJstar, 2 * N_qp * xs.cols());
+  Profiler::CountBytes(Stage::kJstar, 5 * N_qp * sizeof(double));
+  Eigen::ArrayXd p0(N_qp);
+  Eigen::ArrayXd p1(N_qp);
+  Eigen::ArrayXd wg0(N_qp);
+  Eigen::ArrayXd wg1(N_qp);
+  Eigen::ArrayXd wl(N_qp);
+  Eigen::Index q = 0;
+  for (const lf::mesh::Entity *entity : cells) {
+    const lf::base::glb_idx_t k = mesh->Index(*entity);
+    const double gram_det = geometry->IntegrationElement(k);
+    auto u_vals = uFE_mf(*entity, zeta_ref);
+    for (lf::base::size_type l = 0; l < P; ++l, ++q) {
+      const Eigen::Vector2d zeta = geometry->Global(k, zeta_ref.col(l));
+      const double wu = -w_ref[l] * gram_det * u_vals[l];
+      const Eigen::Vector2d psi_grad = psi.grad(zeta);
+      p0[q] = zeta(0);
+      p1[q] = zeta(1);
+      wg0[q] = wu * psi_grad(0);
+      wg1[q] = wu * psi_grad(1);
+      wl[q] = -0.25 * wu * psi.lapl(zeta);
+    }
+  }
+
+  // Sweep over the evaluation points. With r^2 = |x - y|^2 we have
+  // G_x(y) = -log(r^2) / (4 pi) and grad G_x(y) = (x - y) / (2 pi r^2),
+  // so the sum over the quadrature points is an array expression Eigen
+  // evaluates with vectorised log and division.
+  ParallelFor(xs.cols(), num_threads, [&](Eigen::Index begin,
+                                          Eigen::Index end) {
+    Eigen::ArrayXd d0(N_qp);
+    Eigen::ArrayXd d1(N_qp);
+    Eigen::ArrayXd r2(N_qp);
+    for (Eigen::Index i = begin; i < end; ++i) {
+      d0 = xs(0, i) - p0;
+      d1 = xs(1, i) - p1;
+      r2 = d0.square() + d1.square();
+      vals[i] = ((d0 * wg0 + d1 * wg1) / r2 + wl * r2.log()).sum() / M_PI;
+    }
+  });
+#else
+  //====================
+  // Your code goes here
+  //====================
+#endif
+  return vals;
+}
+
+JstarElementVectorProvider::JstarElementVectorProvider(
+    std::shared_ptr<lf::uscalfe::FeSpaceLagrangeO1<double>> fe_space,
+    Eigen::Vector2d x, lf::quad::QuadRule qr)
+    : qr_(std::move(qr)),
+      mesh_p_(fe_space->Mesh()),
+      geometry_(GetTriangleGeometryTable(mesh_p_)),
+      G_(x),
+      psi_(Eigen::Vector2d(0.5, 0.5)) {
+  const auto *rsf_p =
+      fe_space->ShapeFunctionLayout(lf::base::RefEl::kTria());
+  LF_ASSERT_MSG(rsf_p != nullptr, "Missing shape functions on triangles");
+  shape_vals_ = rsf_p->EvalReferenceShapeFunctions(qr_.Points());
+}
+
+Eigen::Vector3d JstarElementVectorProvider::Eval(
+    const lf::mesh::Entity &cell) {
+  LF_ASSERT_MSG(lf::base::RefEl::kTria() == cell.RefEl(),
+                "Function only defined for triangular cells");
+  Eigen::Vector3d elvec = Eigen::Vector3d::Zero();
+#if SOLUTION
+  const lf::base::glb_idx_t k = mesh_p_->Index(cell);
+  const double gram_det = geometry_->IntegrationElement(k);
+  // Same quadrature as in Jstar with u_h replaced by the shape functions
+  for (lf::base::size_type l = 0; l < qr_.NumPoints(); ++l) {
+    const Eigen::Vector2d zeta = geometry_->Global(k, qr_.Points().col(l));
+    const double w = qr_.Weights()[l] * gram_det;
+    elvec -= w *
+             (2.0 * (G_.grad(zeta)).dot(psi_.grad(zeta)) +
+              G_(zeta) * psi_.lapl(zeta)) *
+             shape_vals_.col(l);
+  }
+#else
+  //====================
+  // Your code goes here
+  //====================
+#endif
+  return elvec;
+}
+
+Eigen::VectorXd JstarFunctional(
+    std::shared_ptr<lf::uscalfe::FeSpaceLagrangeO1<double>> fe_space,
+    const Eigen::Vector2d x, const lf::quad::QuadRule &qr) {
+  const lf::assemble::DofHandler &dofh{fe_space->LocGlobMap()};
+  Eigen::VectorXd w_x = Eigen::VectorXd::Zero(dofh.NumDofs());
+  JstarElementVectorProvider elvec_builder(fe_space, x, qr);
+  lf::assemble::AssembleVectorLocally(0, dofh, elvec_builder, w_x);
+  return w_x;
+}
+
+Eigen::MatrixXd JstarFunctionalMatrix(
+    std::shared_ptr<lf::uscalfe::FeSpaceLagrangeO1<double>> fe_space,
+    const Eigen::Matrix2Xd &xs, const lf::quad::QuadRule &qr) {
+  ScopedTimer timer(Stage::kJstar);
+  const lf::assemble::DofHandler &dofh{fe_space->LocGlobMap()};
+  // Column j of W collects the contributions of global shape function j for
+  // all evaluation points, so the innermost loop runs over contiguous memory
+  const Eigen::Index N_points = xs.cols();
+  Eigen::MatrixXd W = Eigen::MatrixXd::Zero(N_points, dofh.NumDofs());
+#if SOLUTION
+  Psi psi(Eigen::Vector2d(0.5, 0.5));
+  std::shared_ptr<const lf::mesh::Mesh> mesh = fe_space->Mesh();
+  const std::shared_ptr<const TriangleGeometryTable> geometry =
+      GetTriangleGeometryTable(mesh);
+  const Eigen::MatrixXd zeta_ref{qr.Points()};
+  const Eigen::VectorXd w_ref{qr.Weights()};
+  const lf::base::size_type P = qr.NumPoints();
+  const Eigen::MatrixXd shape_vals =
+      fe_space->ShapeFunctionLayout(lf::base::RefEl::kTria())
+          ->EvalReferenceShapeFunctions(zeta_ref);
+
+  Profiler::CountBytes(Stage::kJstar, W.size() * sizeof(double));
+  Eigen::VectorXd kernel(N_points);
+  const std::vector<const lf::mesh::Entity *> cells =
+      TransitionZoneCells(mesh, psi);
+  Profiler::CountCells(Stage::kJstar, cells.size());
+  Profiler::CountKernelEvaluations(Stage::kJstar,
+                                   2 * cells.size() * P * N_points);
+  for (const lf::mesh::Entity *entity : cells) {
+    const lf::base::glb_idx_t k = mesh->Index(*entity);
+    const double gram_det = geometry->IntegrationElement(k);
+    const auto dofs = dofh.GlobalDofIndices(*entity);
+    for (lf::base::size_type l = 0; l < P; ++l) {
+      const Eigen::Vector2d zeta = geometry->Global(k, zeta_ref.col(l));
+      const double w = w_ref[l] * gram_det;
+      const Eigen::Vector2d psi_grad = psi.grad(zeta);
+      const double psi_lapl = psi.lapl(zeta);
+      // -w * (2 grad G_x . grad Psi + G_x lapl Psi) for all points x
+      for (Eigen::Index i = 0; i < N_points; ++i) {
+        const Eigen::Vector2d d = xs.col(i) - zeta;
+        const double r2 = d.squaredNorm();
+        kernel[i] =
+            -w * (d.dot(psi_grad) / r2 - 0.25 * std::log(r2) * psi_lapl) /
+            M_PI;
+      }
+      for (lf::base::size_type j = 0; j < dofs.size(); ++j) {
+        W.col(dofs[j]) += shape_vals(j, l) * kernel;
+      }
+    }
+  }
+#else
+  //====================
+  // Your code goes here
+  //====================
+#endif
+  return W;
+}
+
 double StablePointEvaluation(
     std::shared_ptr<lf::uscalfe::FeSpaceLagrangeO1<double>> fe_space,
     Eigen::VectorXd uFE, const Eigen::Vector2d x) {
@@ -195,35 +656,166 @@ double StablePointEvaluation(
   return res;
 }
 
+double StablePointEvaluation(
+    std::shared_ptr<lf::uscalfe::FeSpaceLagrangeO1<double>> fe_space,
+    const Eigen::VectorXd &uFE, const Eigen::Vector2d x,
+    const lf::quad::QuadRule &qr, double adaptive_tol) {
+  double res = 0.0;
+
+  Eigen::Vector2d center(0.5, 0.5);
+  if ((x - center).norm() <= 0.25) {
+    res = adaptive_tol > 0.0
+              ? JstarAdaptive(fe_space, uFE, x, adaptive_tol, qr)
+              : Jstar(fe_space, uFE, x, qr);
+  } else {
+    std::cerr << "The point does not fulfill the assumptions" << std::endl;
+  }
+
+  return res;
+}
+
+Eigen::VectorXd StablePointEvaluation(
+    std::shared_ptr<lf::uscalfe::FeSpaceLagrangeO1<double>> fe_space,
+    const Eigen::VectorXd &uFE, const Eigen::Matrix2Xd &xs,
+    const lf::quad::QuadRule &qr) {
+  Eigen::VectorXd res = Eigen::VectorXd::Zero(xs.cols());
+
+  // Jstar for all admissible points in a single pass over the mesh
+  Eigen::Vector2d center(0.5, 0.5);
+  std::vector<Eigen::Index> admissible;
+  for (Eigen::Index i = 0; i < xs.cols(); ++i) {
+    if ((xs.col(i) - center).norm() <= 0.25) {
+      admissible.push_back(i);
+    } else {
+      std::cerr << "The point does not fulfill the assumptions" << std::endl;
+    }
+  }
+  Eigen::Matrix2Xd xs_admissible(2, admissible.size());
+  for (std::size_t j = 0; j < admissible.size(); ++j) {
+    xs_admissible.col(j) = xs.col(admissible[j]);
+  }
+  const Eigen::VectorXd vals = JstarMulti(fe_space, uFE, xs_admissible, qr);
+  for (std::size_t j = 0; j < admissible.size(); ++j) {
+    res[admissible[j]] = vals[j];
+  }
+
+  return res;
+}
+
 double EvaluateFEFunction(
     std::shared_ptr<lf::uscalfe::FeSpaceLagrangeO1<double>> fe_space,
     const Eigen::VectorXd &uFE, Eigen::Vector2d global, double tol) {
-  // Extract mesh
+  ScopedTimer timer(Stage::kEvaluateFEFunction);
+  // Extract mesh and its precomputed inverse affine maps
   auto mesh_p = fe_space->Mesh();
+  const std::shared_ptr<const TriangleGeometryTable> geometry =
+      GetTriangleGeometryTable(mesh_p);
   // wrap coefficient vector into a FE mesh-function
   lf::fe::MeshFunctionFE mf(fe_space, uFE);
 
-  for (const lf::mesh::Entity *entity_p : mesh_p->Entities(0)) {
-    LF_ASSERT_MSG(lf::base::RefEl::kTria() == entity_p->RefEl(),
-                  "Function only defined for triangular cells");
-
-    // compute geometric information about the cell
-    const lf::geometry::Geometry *geo_p = entity_p->Geometry();
-    Eigen::MatrixXd corners = lf::geometry::Corners(*geo_p);
-
+  // The scanned cells are counted once per call, not inside the search loop
+  for (Eigen::Index k = 0; k < geometry->NumCells(); ++k) {
     // transform global coordinates to local coordinates on the cell
-    Eigen::Matrix2d A;
-    A << corners.col(1) - corners.col(0), corners.col(2) - corners.col(0);
-    Eigen::Vector2d b;
-    b << global - corners.col(0);
-    Eigen::Vector2d loc = A.fullPivLu().solve(b);
+    const Eigen::Vector2d loc = geometry->Local(k, global);
 
     // evaluate meshfunction, if local coordinates lie in the reference triangle
     if (loc(0) >= 0 - tol && loc(1) >= 0 - tol && loc(0) + loc(1) <= 1 + tol) {
-      return mf(*entity_p, loc)[0];
+      Profiler::CountCells(Stage::kEvaluateFEFunction, k + 1);
+      return mf(*mesh_p->EntityByIndex(0, k), loc)[0];
     }
   }
+  Profiler::CountCells(Stage::kEvaluateFEFunction, geometry->NumCells());
   return 0.0;
 }
 
+double EvaluateFEFunction(
+    std::shared_ptr<lf::uscalfe::FeSpaceLagrangeO1<double>> fe_space,
+    const Eigen::VectorXd &uFE, const PointLocator &locator,
+    Eigen::Vector2d global, double tol) {
+  LF_ASSERT_MSG(locator.Mesh() == fe_space->Mesh(),
+                "Locator built for a different mesh");
+  ScopedTimer timer(Stage::kEvaluateFEFunction);
+  Profiler::CountCells(Stage::kEvaluateFEFunction, 1);
+  // Look up the cell containing the point and its local coordinates
+  auto [entity_p, loc] = locator.Locate(global, tol);
+  if (entity_p == nullptr) {
+    return 0.0;
+  }
+  // wrap coefficient vector into a FE mesh-function and evaluate it
+  lf::fe::MeshFunctionFE mf(fe_space, uFE);
+  return mf(*entity_p, loc)[0];
+}
+
+Eigen::VectorXd EvaluateFEFunction(
+    std::shared_ptr<lf::uscalfe::FeSpaceLagrangeO1<double>> fe_space,
+    const Eigen::VectorXd &uFE, const Eigen::Matrix2Xd &points, double tol) {
+  const PointLocator locator(fe_space->Mesh());
+  return EvaluateFEFunction(fe_space, uFE, locator, points, tol);
+}
+
+Eigen::VectorXd EvaluateFEFunction(
+    std::shared_ptr<lf::uscalfe::FeSpaceLagrangeO1<double>> fe_space,
+    const Eigen::VectorXd &uFE, const PointLocator &locator,
+    const Eigen::Matrix2Xd &points, double tol) {
+  LF_ASSERT_MSG(locator.Mesh() == fe_space->Mesh(),
+                "Locator built for a different mesh");
+  ScopedTimer timer(Stage::kEvaluateFEFunction);
+  auto mesh_p = fe_space->Mesh();
+  const lf::base::size_type N_cells = mesh_p->NumEntities(0);
+  const Eigen::Index N_points = points.cols();
+  Eigen::VectorXd values = Eigen::VectorXd::Zero(N_points);
+
+  // Locate all points and bucket them by their containing cell (counting
+  // sort), points outside the mesh are dropped
+  std::vector<lf::base::glb_idx_t> cell_of(N_points, lf::base::kIdxNil);
+  Eigen::Matrix2Xd local(2, N_points);
+  std::vector<Eigen::Index> offsets(N_cells + 1, 0);
+  for (Eigen::Index i = 0; i < N_points; ++i) {
+    auto [entity_p, loc] = locator.Locate(points.col(i), tol);
+    if (entity_p != nullptr) {
+      cell_of[i] = mesh_p->Index(*entity_p);
+      local.col(i) = loc;
+      ++offsets[cell_of[i] + 1];
+    }
+  }
+  for (lf::base::size_type k = 0; k < N_cells; ++k) {
+    offsets[k + 1] += offsets[k];
+  }
+  std::vector<Eigen::Index> sorted(offsets.back());
+  std::vector<Eigen::Index> fill(offsets.begin(), offsets.end() - 1);
+  Profiler::CountBytes(
+      Stage::kEvaluateFEFunction,
+      N_points * (sizeof(lf::base::glb_idx_t) + 2 * sizeof(double)) +
+          (sorted.size() + 2 * N_cells + 1) * sizeof(Eigen::Index));
+  for (Eigen::Index i = 0; i < N_points; ++i) {
+    if (cell_of[i] != lf::base::kIdxNil) {
+      sorted[fill[cell_of[i]]++] = i;
+    }
+  }
+
+  // wrap coefficient vector into a FE mesh-function and evaluate it once per
+  // non-empty cell for all points located in the cell
+  lf::fe::MeshFunctionFE mf(fe_space, uFE);
+  Eigen::MatrixXd cell_local;
+  std::uint64_t N_evaluated_cells = 0;
+  for (lf::base::size_type k = 0; k < N_cells; ++k) {
+    const Eigen::Index n = offsets[k + 1] - offsets[k];
+    if (n == 0) {
+      continue;
+    }
+    ++N_evaluated_cells;
+    cell_local.resize(2, n);
+    for (Eigen::Index l = 0; l < n; ++l) {
+      cell_local.col(l) = local.col(sorted[offsets[k] + l]);
+    }
+    const std::vector<double> cell_values =
+        mf(*mesh_p->EntityByIndex(0, k), cell_local);
+    for (Eigen::Index l = 0; l < n; ++l) {
+      values(sorted[offsets[k] + l]) = cell_values[l];
+    }
+  }
+  Profiler::CountCells(Stage::kEvaluateFEFunction, N_evaluated_cells);
+  return values;
+}
+
 }  // namespace StableEvaluationAtAPoint
\ No newline at end of file
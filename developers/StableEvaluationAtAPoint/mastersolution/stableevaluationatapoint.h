@@ -15,13 +15,26 @@
 #include <lf/geometry/geometry.h>
 #include <lf/mesh/mesh.h>
 #include <lf/mesh/utils/utils.h>
+#include <lf/quad/quad.h>
 #include <lf/uscalfe/uscalfe.h>
 
 #include <Eigen/Core>
 #include <Eigen/SparseCore>
-#include <Eigen/SparseLU>
+#include <cmath>
 #include <memory>
+#include <type_traits>
 #include <utility>
+#include <vector>
+
+#include "boundaryquadraturecache.h"
+#include "csrassembler.h"
+#include "dirichletsolver.h"
+#include "linearsolver.h"
+#include "multigrid.h"
+#include "pointlocator.h"
+#include "profiler.h"
+#include "reducedsystem.h"
+#include "trianglegeometry.h"
 
 namespace StableEvaluationAtAPoint {
 
@@ -128,6 +141,150 @@ double PDL(std::shared_ptr<const lf::mesh::Mesh> mesh_p, FUNCTOR &&v,
 }
 /* SAM_LISTING_END_2 */
 
+/** @brief Evaluates the Integral P_SL using the quadrature rule on the
+ * boundary edges stored in cache. For the default midpoint rule of the cache
+ * this is equivalent to PSL(mesh_p, v, x) unless x is close to the boundary.
+ * There, the rule is refined towards x on nearby edges, unless disabled in
+ * the cache, see BoundaryQuadratureCache::NearFieldRule().
+ * @note "Close" is relative to the edge length: with the default
+ * near_field_ratio of 1 every point within one edge length of an edge is
+ * refined. On coarse meshes this covers the interior, so the values differ
+ * from PSL(mesh_p, v, x), e.g. PointEval() on a square with one edge per side
+ * would give an error of 0.0078 instead of 0.0784. Build the cache with
+ * near_field_ratio = 0 to reproduce the mesh-based functions exactly.
+ */
+template <typename FUNCTOR>
+double PSL(const BoundaryQuadratureCache &cache, FUNCTOR &&v,
+           const Eigen::Vector2d x) {
+  ScopedTimer timer(Stage::kPotentials);
+  // Not counting the extra points of near-field rules
+  Profiler::CountKernelEvaluations(Stage::kPotentials, cache.NumPoints());
+  double value = 0.0;
+  FundamentalSolution G(x);
+#if SOLUTION
+  const Eigen::Matrix2Xd &points = cache.Points();
+  const Eigen::VectorXd &weights = cache.Weights();
+  const Eigen::Index P = cache.PointsPerEdge();
+  Eigen::Matrix2Xd near_points;
+  Eigen::VectorXd near_weights;
+  for (Eigen::Index k = 0; k < cache.NumEdges(); ++k) {
+    if (cache.NearFieldRule(k, x, near_points, near_weights)) {
+      for (Eigen::Index l = 0; l < near_weights.size(); ++l) {
+        const Eigen::Vector2d y = near_points.col(l);
+        value += v(y) * G(y) * near_weights[l];
+      }
+    } else {
+      for (Eigen::Index l = k * P; l < (k + 1) * P; ++l) {
+        const Eigen::Vector2d y = points.col(l);
+        value += v(y) * G(y) * weights[l];
+      }
+    }
+  }
+#else
+  //====================
+  // Your code goes here
+  //====================
+#endif
+  return value;
+}
+
+/** @brief Evaluates the Integral P_DL using the quadrature rule on the
+ * boundary edges stored in cache, see PSL() above.
+ */
+template <typename FUNCTOR>
+double PDL(const BoundaryQuadratureCache &cache, FUNCTOR &&v,
+           const Eigen::Vector2d x) {
+  ScopedTimer timer(Stage::kPotentials);
+  Profiler::CountKernelEvaluations(Stage::kPotentials, cache.NumPoints());
+  double value = 0.0;
+  FundamentalSolution G(x);
+#if SOLUTION
+  const Eigen::Matrix2Xd &points = cache.Points();
+  const Eigen::Matrix2Xd &normals = cache.Normals();
+  const Eigen::VectorXd &weights = cache.Weights();
+  const Eigen::Index P = cache.PointsPerEdge();
+  Eigen::Matrix2Xd near_points;
+  Eigen::VectorXd near_weights;
+  for (Eigen::Index k = 0; k < cache.NumEdges(); ++k) {
+    // The normal is constant on the edge
+    const Eigen::Vector2d n = normals.col(k * P);
+    if (cache.NearFieldRule(k, x, near_points, near_weights)) {
+      for (Eigen::Index l = 0; l < near_weights.size(); ++l) {
+        const Eigen::Vector2d y = near_points.col(l);
+        value += v(y) * (G.grad(y)).dot(n) * near_weights[l];
+      }
+    } else {
+      for (Eigen::Index l = k * P; l < (k + 1) * P; ++l) {
+        const Eigen::Vector2d y = points.col(l);
+        value += v(y) * (G.grad(y)).dot(n) * weights[l];
+      }
+    }
+  }
+#else
+  //====================
+  // Your code goes here
+  //====================
+#endif
+  return value;
+}
+
+/** @brief Evaluates P_SL at many points at once
+ * @param v_vals: values of the density at the quadrature points stored in
+ * cache
+ * @param xs: evaluation points, one per column
+ * @param num_threads: number of threads the evaluation points are distributed
+ * over, 0 selects the number of hardware threads
+ * @param treecode_tol: if positive, the sums over the boundary edges are
+ * approximated by a BoundaryTreecode with this tolerance instead of being
+ * computed directly. Building the tree only pays off for many points, so
+ * PSL(), PDL() and PointEval(), which evaluate at a single point, always sum
+ * directly.
+ * @return PSL(cache, v, xs.col(i)) in entry i, provided xs.col(i) is not
+ * close to the boundary, as no near-field refinement is applied
+ */
+Eigen::VectorXd PSLMultiValues(const BoundaryQuadratureCache &cache,
+                               const Eigen::VectorXd &v_vals,
+                               const Eigen::Matrix2Xd &xs,
+                               unsigned int num_threads = 0,
+                               double treecode_tol = 0.0);
+
+/** @brief Evaluates P_DL at many points at once, see PSLMultiValues() */
+Eigen::VectorXd PDLMultiValues(const BoundaryQuadratureCache &cache,
+                               const Eigen::VectorXd &v_vals,
+                               const Eigen::Matrix2Xd &xs,
+                               unsigned int num_threads = 0,
+                               double treecode_tol = 0.0);
+
+/** @brief Evaluates P_SL at all points given by the columns of xs
+ *
+ * The density v is evaluated once at the quadrature points on the boundary,
+ * the sum over them is then carried out for all points by PSLMultiValues().
+ */
+template <typename FUNCTOR>
+Eigen::VectorXd PSLMulti(const BoundaryQuadratureCache &cache, FUNCTOR &&v,
+                         const Eigen::Matrix2Xd &xs,
+                         unsigned int num_threads = 0,
+                         double treecode_tol = 0.0) {
+  Eigen::VectorXd v_vals(cache.NumPoints());
+  for (Eigen::Index l = 0; l < cache.NumPoints(); ++l) {
+    v_vals[l] = v(Eigen::Vector2d(cache.Points().col(l)));
+  }
+  return PSLMultiValues(cache, v_vals, xs, num_threads, treecode_tol);
+}
+
+/** @brief Evaluates P_DL at all points given by the columns of xs */
+template <typename FUNCTOR>
+Eigen::VectorXd PDLMulti(const BoundaryQuadratureCache &cache, FUNCTOR &&v,
+                         const Eigen::Matrix2Xd &xs,
+                         unsigned int num_threads = 0,
+                         double treecode_tol = 0.0) {
+  Eigen::VectorXd v_vals(cache.NumPoints());
+  for (Eigen::Index l = 0; l < cache.NumPoints(); ++l) {
+    v_vals[l] = v(Eigen::Vector2d(cache.Points().col(l)));
+  }
+  return PDLMultiValues(cache, v_vals, xs, num_threads, treecode_tol);
+}
+
 /* SAM_LISTING_BEGIN_3 */
 /** @brief  This function computes u(x) = P_SL(grad u * n) - P_DL(u).
  * For u(x) = log( (x + (1, 0)^T).norm() ) and x = (0.3, 0.4)^T,
@@ -140,6 +297,13 @@ double PDL(std::shared_ptr<const lf::mesh::Mesh> mesh_p, FUNCTOR &&v,
 double PointEval(std::shared_ptr<const lf::mesh::Mesh> mesh_p);
 /* SAM_LISTING_END_3 */
 
+/** @brief Same as above, approximating the potentials with the quadrature
+ * rule qr on the reference segment applied on every boundary edge instead of
+ * the midpoint rule
+ */
+double PointEval(std::shared_ptr<const lf::mesh::Mesh> mesh_p,
+                 const lf::quad::QuadRule &qr);
+
 class Psi {
  public:
   Psi(Eigen::Vector2d center) : center_(center) {}
@@ -151,10 +315,33 @@ class Psi {
   // computes the laplacian of Psi_x at y
   double lapl(Eigen::Vector2d y);
 
+  Eigen::Vector2d Center() const { return center_; }
+  // Psi_x is constant outside the annulus InnerRadius() < |y - center| <
+  // OuterRadius(), hence its derivatives vanish there
+  static double InnerRadius() { return 0.25 * std::sqrt(2); }
+  static double OuterRadius() { return 0.5; }
+
  private:
   Eigen::Vector2d center_ = Eigen::Vector2d(0.5, 0.5);
 };
 
+/** @brief Checks whether a triangular cell meets the annulus in which the
+ * derivatives of psi do not vanish
+ *
+ * The test is conservative: cells touching the annulus only up to round-off
+ * are reported as meeting it.
+ */
+bool MeetsTransitionZone(const lf::mesh::Entity &cell, const Psi &psi);
+/** @brief Same as above for the triangle with the given corners */
+bool MeetsTransitionZone(const Eigen::Matrix<double, 2, 3> &corners,
+                         const Psi &psi);
+
+/** @brief Collects the cells of the mesh meeting the annulus in which the
+ * derivatives of psi do not vanish. Only these cells contribute to Jstar.
+ */
+std::vector<const lf::mesh::Entity *> TransitionZoneCells(
+    const std::shared_ptr<const lf::mesh::Mesh> &mesh_p, const Psi &psi);
+
 /** @brief Computes Jstar
  * @param fe_space: finite element space defined on a triangular mesh of the
  * square
@@ -168,6 +355,120 @@ double Jstar(std::shared_ptr<lf::uscalfe::FeSpaceLagrangeO1<double>> fe_space,
 
 /* SAM_LISTING_END_4 */
 
+/** @brief Computes Jstar integrating over the given cells only
+ * @param cells: cells to integrate over, must contain the cells returned by
+ * TransitionZoneCells() for the same result as Jstar above
+ * @param qr: quadrature rule on the reference triangle applied on every cell
+ */
+double Jstar(std::shared_ptr<lf::uscalfe::FeSpaceLagrangeO1<double>> fe_space,
+             const Eigen::VectorXd &uFE, const Eigen::Vector2d x,
+             const std::vector<const lf::mesh::Entity *> &cells,
+             const lf::quad::QuadRule &qr =
+                 lf::quad::make_TriaQR_MidpointRule());
+
+/** @brief Computes Jstar using the quadrature rule qr on the reference
+ * triangle instead of the midpoint rule, e.g. a rule of higher degree
+ * obtained from lf::quad::make_QuadRule(lf::base::RefEl::kTria(), degree)
+ */
+double Jstar(std::shared_ptr<lf::uscalfe::FeSpaceLagrangeO1<double>> fe_space,
+             const Eigen::VectorXd &uFE, const Eigen::Vector2d x,
+             const lf::quad::QuadRule &qr);
+
+/** @brief Computes Jstar with adaptive quadrature
+ *
+ * Since grad Psi is continuous, integration by parts of the term with
+ * lapl Psi yields the equivalent representation
+ *   Jstar = int (G_x grad u_h - u_h grad G_x) . grad Psi dy,
+ * whose integrand has no jumps across the circles bounding the transition
+ * zone, where lapl Psi jumps.
+ * On every cell meeting the transition zone the rule qr is compared with its
+ * composite version on the four congruent subtriangles. Where they differ by
+ * more than the share of tol corresponding to the area of the triangle, the
+ * subtriangles are refined recursively. Hence only the parts of the
+ * transition zone where the integrand varies strongly receive additional
+ * quadrature points.
+ * @param tol: requested absolute accuracy of the quadrature
+ * @param qr: basic quadrature rule on the reference triangle
+ * @param max_depth: maximal number of subdivisions of a cell
+ */
+double JstarAdaptive(
+    std::shared_ptr<lf::uscalfe::FeSpaceLagrangeO1<double>> fe_space,
+    const Eigen::VectorXd &uFE, const Eigen::Vector2d x, double tol,
+    const lf::quad::QuadRule &qr =
+        lf::quad::make_QuadRule(lf::base::RefEl::kTria(), 5),
+    unsigned int max_depth = 8);
+
+/** @brief Computes Jstar for many evaluation points at once
+ *
+ * Quadrature points, weights, values of uFE and derivatives of Psi are
+ * computed in a single pass over the mesh and shared by all evaluation
+ * points, only the fundamental solution depends on the point.
+ * @param fe_space: finite element space defined on a triangular mesh of the
+ * square
+ * @param uFE: Coefficient vector of the finite element function wrt the
+ * fe_space
+ * @param xs: Evaluation points, one per column
+ * @param qr: quadrature rule on the reference triangle
+ * @param num_threads: number of threads the evaluation points are distributed
+ * over, 0 selects the number of hardware threads
+ * @return Jstar(fe_space, uFE, xs.col(i), qr) in entry i
+ */
+Eigen::VectorXd JstarMulti(
+    std::shared_ptr<lf::uscalfe::FeSpaceLagrangeO1<double>> fe_space,
+    const Eigen::VectorXd &uFE, const Eigen::Matrix2Xd &xs,
+    const lf::quad::QuadRule &qr = lf::quad::make_TriaQR_MidpointRule(),
+    unsigned int num_threads = 0);
+
+/** @brief Element vector provider for the linear functional uFE -> Jstar
+ *
+ * Since Jstar(fe_space, uFE, x) is linear in uFE, it equals w_x.dot(uFE) for
+ * a vector w_x depending only on the mesh and x. The element vectors
+ * provided by this class assemble w_x using the same quadrature as Jstar.
+ */
+class JstarElementVectorProvider {
+ public:
+  JstarElementVectorProvider(
+      std::shared_ptr<lf::uscalfe::FeSpaceLagrangeO1<double>> fe_space,
+      Eigen::Vector2d x,
+      lf::quad::QuadRule qr = lf::quad::make_TriaQR_MidpointRule());
+  // Cells outside the support of the derivatives of Psi do not contribute
+  bool isActive(const lf::mesh::Entity &cell) {
+    return MeetsTransitionZone(geometry_->Corners(mesh_p_->Index(cell)), psi_);
+  }
+  Eigen::Vector3d Eval(const lf::mesh::Entity &cell);
+
+ private:
+  const lf::quad::QuadRule qr_;
+  std::shared_ptr<const lf::mesh::Mesh> mesh_p_;
+  std::shared_ptr<const TriangleGeometryTable> geometry_;
+  // Values of the reference shape functions at the quadrature points
+  Eigen::MatrixXd shape_vals_;
+  FundamentalSolution G_;
+  Psi psi_;
+};
+
+/** @brief Assembles the vector w_x with Jstar(fe_space, uFE, x) = w_x.dot(uFE)
+ * @param fe_space: finite element space defined on a triangular mesh of the
+ * square
+ * @param x: Evaluation point
+ * @param qr: quadrature rule on the reference triangle
+ */
+Eigen::VectorXd JstarFunctional(
+    std::shared_ptr<lf::uscalfe::FeSpaceLagrangeO1<double>> fe_space,
+    const Eigen::Vector2d x,
+    const lf::quad::QuadRule &qr = lf::quad::make_TriaQR_MidpointRule());
+
+/** @brief Assembles the matrix W with Jstar(fe_space, uFE, xs.col(i)) =
+ * (W * uFE)(i)
+ *
+ * Row i of W is the vector w_x of JstarFunctional() for x = xs.col(i). All
+ * rows are assembled in a single pass over the mesh.
+ */
+Eigen::MatrixXd JstarFunctionalMatrix(
+    std::shared_ptr<lf::uscalfe::FeSpaceLagrangeO1<double>> fe_space,
+    const Eigen::Matrix2Xd &xs,
+    const lf::quad::QuadRule &qr = lf::quad::make_TriaQR_MidpointRule());
+
 /** @brief Verifies that the assumptions on Psi_x are satisfied and evaluates
  * Jstar
  * @param fe_space: finite element space defined on a triangular mesh of the
@@ -180,11 +481,67 @@ double StablePointEvaluation(
     std::shared_ptr<lf::uscalfe::FeSpaceLagrangeO1<double>> fe_space,
     Eigen::VectorXd uFE, const Eigen::Vector2d x);
 
-/** @brief Solves the Laplace equation using Dirichlet conditions g */
-template <typename FUNCTOR>
+/** @brief Same as above, evaluating Jstar with the quadrature rule qr
+ * @param adaptive_tol: if positive, Jstar is computed by JstarAdaptive() with
+ * this tolerance and qr as basic rule
+ */
+double StablePointEvaluation(
+    std::shared_ptr<lf::uscalfe::FeSpaceLagrangeO1<double>> fe_space,
+    const Eigen::VectorXd &uFE, const Eigen::Vector2d x,
+    const lf::quad::QuadRule &qr, double adaptive_tol = 0.0);
+
+/** @brief Evaluates Jstar at all points given by the columns of xs that
+ * satisfy the assumptions on Psi_x, using JstarMulti() with the quadrature
+ * rule qr
+ * @return Jstar at xs.col(i) in entry i, 0 for points violating the
+ * assumptions
+ */
+Eigen::VectorXd StablePointEvaluation(
+    std::shared_ptr<lf::uscalfe::FeSpaceLagrangeO1<double>> fe_space,
+    const Eigen::VectorXd &uFE, const Eigen::Matrix2Xd &xs,
+    const lf::quad::QuadRule &qr = lf::quad::make_TriaQR_MidpointRule());
+
+/** @brief Source term policy of SolveBVP() for the Laplace equation, f = 0.
+ * The load vector vanishes, its assembly is skipped at compile time.
+ */
+struct ZeroSource {};
+
+/** @brief Assembles the load vector of the source term f
+ * @param f either ZeroSource or a functor Eigen::Vector2d -> double
+ * @param assembler if not nullptr, used for the assembly instead of
+ * lf::assemble::AssembleVectorLocally()
+ */
+template <typename SOURCE>
+Eigen::VectorXd AssembleLoadVector(
+    const std::shared_ptr<lf::uscalfe::FeSpaceLagrangeO1<double>> &fe_space_p,
+    const SOURCE &f, const CSRAssembler *assembler = nullptr) {
+  const lf::assemble::DofHandler &dofh{fe_space_p->LocGlobMap()};
+  if constexpr (std::is_same_v<SOURCE, ZeroSource>) {
+    return Eigen::VectorXd::Zero(dofh.NumDofs());
+  } else {
+    lf::mesh::utils::MeshFunctionGlobal mf_f{f};
+    lf::uscalfe::ScalarLoadElementVectorProvider<double, decltype(mf_f)>
+        elvec_builder(fe_space_p, mf_f);
+    if (assembler != nullptr) {
+      return assembler->AssembleVector(elvec_builder);
+    }
+    Eigen::VectorXd phi = Eigen::VectorXd::Zero(dofh.NumDofs());
+    AssembleVectorLocally(0, dofh, elvec_builder, phi);
+    return phi;
+  }
+}
+
+/** @brief Solves the Laplace equation using Dirichlet conditions g
+ * @param solver_type linear solver applied to the Galerkin system
+ * @param info if not nullptr, receives iteration count and residual of the
+ * linear solve
+ * @param f source term of -Laplace(u) = f, ZeroSource by default
+ */
+template <typename FUNCTOR, typename SOURCE = ZeroSource>
 Eigen::VectorXd SolveBVP(
     const std::shared_ptr<lf::uscalfe::FeSpaceLagrangeO1<double>> &fe_space_p,
-    FUNCTOR &&g) {
+    FUNCTOR &&g, SolverType solver_type = SolverType::kSparseLU,
+    SolverInfo *info = nullptr, const SOURCE &f = SOURCE{}) {
   Eigen::VectorXd discrete_solution;
 
   // Extract mesh and Dofhandler
@@ -198,24 +555,19 @@ Eigen::VectorXd SolveBVP(
 
   // Dirichlet data
   lf::mesh::utils::MeshFunctionGlobal mf_g{g};
-  // Right-hand side source function f
-  lf::mesh::utils::MeshFunctionConstant mf_f{0.0};
 
   // I : ASSEMBLY
+  ScopedTimer assembly_timer(Stage::kAssembly);
+  Profiler::CountCells(Stage::kAssembly, mesh_p->NumEntities(0));
   // Matrix in triplet format holding Galerkin matrix, zero initially.
   lf::assemble::COOMatrix<double> A(N_dofs, N_dofs);
-  // Right hand side vector, must be initialized with 0!
-  Eigen::Matrix<double, Eigen::Dynamic, 1> phi(N_dofs);
-  phi.setZero();
 
   // Compute Galerkin Matrix
   lf::uscalfe::LinearFELaplaceElementMatrix elmat_builder{};
   lf::assemble::AssembleMatrixLocally(0, dofh, dofh, elmat_builder, A);
 
   // Compute right-hand side vector
-  lf::uscalfe::ScalarLoadElementVectorProvider<double, decltype(mf_f)>
-      elvec_builder(fe_space_p, mf_f);
-  AssembleVectorLocally(0, dofh, elvec_builder, phi);
+  Eigen::VectorXd phi = AssembleLoadVector(fe_space_p, f);
 
   // Impose essential Boundary conditions
   auto bd_flags{lf::mesh::utils::flagEntitiesOnBoundary(mesh_p, 1)};
@@ -231,16 +583,163 @@ Eigen::VectorXd SolveBVP(
   // Assembly completed! Convert COO matrix A into CRS format using Eigen's
   // internal conversion routines.
   Eigen::SparseMatrix<double> A_sparse = A.makeSparse();
+  Profiler::CountBytes(
+      Stage::kAssembly,
+      A.triplets().size() * sizeof(Eigen::Triplet<double>) +
+          A_sparse.nonZeros() * (sizeof(double) + sizeof(int)));
+  assembly_timer.Stop();
 
   // II : SOLVING  THE LINEAR SYSTEM
-  Eigen::SparseLU<Eigen::SparseMatrix<double>> solver;
-  solver.compute(A_sparse);
-  LF_VERIFY_MSG(solver.info() == Eigen::Success, "LU decomposition failed");
-  discrete_solution = solver.solve(phi);
-  LF_VERIFY_MSG(solver.info() == Eigen::Success, "Solving LSE failed");
+  discrete_solution = SolveLSE(A_sparse, phi, solver_type, info);
 
   return discrete_solution;
 };
+
+/** @brief Same as above, but the Galerkin matrix is assembled directly in
+ * compressed format using the sparsity pattern of assembler, which can be
+ * reused for further calls on the same finite element space. Matrix and
+ * right-hand side are assembled by the number of threads of assembler.
+ * @param assembler must be built for the DofHandler of fe_space_p
+ */
+template <typename FUNCTOR, typename SOURCE = ZeroSource>
+Eigen::VectorXd SolveBVP(
+    const std::shared_ptr<lf::uscalfe::FeSpaceLagrangeO1<double>> &fe_space_p,
+    const CSRAssembler &assembler, FUNCTOR &&g,
+    SolverType solver_type = SolverType::kSparseLU,
+    SolverInfo *info = nullptr, const SOURCE &f = SOURCE{}) {
+  std::shared_ptr<const lf::mesh::Mesh> mesh_p = fe_space_p->Mesh();
+  const lf::assemble::DofHandler &dofh{fe_space_p->LocGlobMap()};
+  auto N_dofs = dofh.NumDofs();
+  LF_ASSERT_MSG(assembler.Pattern().rows() == N_dofs,
+                "Assembler does not match the finite element space");
+
+  // Dirichlet data
+  lf::mesh::utils::MeshFunctionGlobal mf_g{g};
+
+  // I : ASSEMBLY
+  ScopedTimer assembly_timer(Stage::kAssembly);
+  Profiler::CountCells(Stage::kAssembly, mesh_p->NumEntities(0));
+  lf::uscalfe::LinearFELaplaceElementMatrix elmat_builder{};
+  Eigen::SparseMatrix<double> A = assembler.Assemble(elmat_builder);
+  Profiler::CountBytes(Stage::kAssembly,
+                       A.nonZeros() * (sizeof(double) + sizeof(int)));
+  Eigen::VectorXd phi = AssembleLoadVector(fe_space_p, f, &assembler);
+
+  // Impose essential boundary conditions
+  auto bd_flags{lf::mesh::utils::flagEntitiesOnBoundary(mesh_p, 1)};
+  auto edges_flag_values_Dirichlet{
+      lf::fe::InitEssentialConditionFromFunction(*fe_space_p, bd_flags, mf_g)};
+  FixFlaggedSolutionComponentsCSR(
+      [&edges_flag_values_Dirichlet](Eigen::Index gdof_idx) {
+        return edges_flag_values_Dirichlet[gdof_idx];
+      },
+      A, phi);
+  assembly_timer.Stop();
+
+  // II : SOLVING  THE LINEAR SYSTEM
+  return SolveLSE(A, phi, solver_type, info);
+}
+
+/** @brief Same as SolveBVP(), but the Dirichlet dofs are removed from the
+ * linear system instead of being fixed by identity rows, see ReducedSystem.
+ * Only the s.p.d. interior system is solved, so besides the direct solvers
+ * also the CG variants of SolverType apply to a smaller system.
+ */
+template <typename FUNCTOR, typename SOURCE = ZeroSource>
+Eigen::VectorXd SolveBVPReduced(
+    const std::shared_ptr<lf::uscalfe::FeSpaceLagrangeO1<double>> &fe_space_p,
+    FUNCTOR &&g, SolverType solver_type = SolverType::kSparseLU,
+    SolverInfo *info = nullptr, const SOURCE &f = SOURCE{}) {
+  std::shared_ptr<const lf::mesh::Mesh> mesh_p = fe_space_p->Mesh();
+  const lf::assemble::DofHandler &dofh{fe_space_p->LocGlobMap()};
+  auto N_dofs = dofh.NumDofs();
+
+  // Dirichlet data
+  lf::mesh::utils::MeshFunctionGlobal mf_g{g};
+  auto bd_flags{lf::mesh::utils::flagEntitiesOnBoundary(mesh_p, 1)};
+  auto edges_flag_values_Dirichlet{
+      lf::fe::InitEssentialConditionFromFunction(*fe_space_p, bd_flags, mf_g)};
+  std::vector<bool> is_dirichlet(N_dofs);
+  Eigen::VectorXd g_vals = Eigen::VectorXd::Zero(N_dofs);
+  for (lf::assemble::size_type i = 0; i < N_dofs; ++i) {
+    is_dirichlet[i] = edges_flag_values_Dirichlet[i].first;
+    if (is_dirichlet[i]) {
+      g_vals[i] = edges_flag_values_Dirichlet[i].second;
+    }
+  }
+
+  // I : ASSEMBLY
+  ScopedTimer assembly_timer(Stage::kAssembly);
+  Profiler::CountCells(Stage::kAssembly, mesh_p->NumEntities(0));
+  // The full Galerkin matrix only lives until it is split into blocks
+  ReducedSystem system;
+  {
+    lf::assemble::COOMatrix<double> A(N_dofs, N_dofs);
+    lf::uscalfe::LinearFELaplaceElementMatrix elmat_builder{};
+    lf::assemble::AssembleMatrixLocally(0, dofh, dofh, elmat_builder, A);
+    Profiler::CountBytes(Stage::kAssembly, A.triplets().size() *
+                                               sizeof(Eigen::Triplet<double>));
+    system = ReducedSystem(A.makeSparse(), is_dirichlet);
+  }
+  if (system.NumInterior() == 0) {
+    if (info != nullptr) {
+      *info = SolverInfo{};
+    }
+    return g_vals;
+  }
+  const Eigen::VectorXd phi_I =
+      system.Restrict(AssembleLoadVector(fe_space_p, f)) -
+      system.Lifting(g_vals);
+  assembly_timer.Stop();
+
+  // II : SOLVING THE INTERIOR SYSTEM
+  const Eigen::VectorXd u_I =
+      SolveLSE(system.Matrix(), phi_I, solver_type, info);
+  return system.Expand(u_I, g_vals);
+}
+
+/** @brief Solves the Laplace equation using Dirichlet conditions g on all
+ * levels of a mesh hierarchy by nested iteration
+ *
+ * Level 0 is solved directly. On every finer level the multigrid V-cycles
+ * start from the interpolated solution of the next coarser level, whose error
+ * is already of the order of the discretization error, so few cycles suffice.
+ * @param mg multigrid hierarchy, e.g. built from
+ * lf::refinement::GenerateMeshHierarchyByUniformRefinemnt()
+ * @param tol relative residual at which the V-cycles stop on each level
+ * @param infos if not nullptr, receives the statistics of every level
+ * @return coefficient vectors of the solutions on levels 0, ..., L
+ */
+template <typename FUNCTOR>
+std::vector<Eigen::VectorXd> SolveBVPMultigrid(
+    const MultigridHierarchy &mg, FUNCTOR &&g, double tol = 1.0E-10,
+    std::vector<SolverInfo> *infos = nullptr) {
+  lf::mesh::utils::MeshFunctionGlobal mf_g{g};
+  std::vector<Eigen::VectorXd> solutions(mg.NumLevels());
+  if (infos != nullptr) {
+    infos->assign(mg.NumLevels(), SolverInfo{});
+  }
+  for (unsigned int l = 0; l < mg.NumLevels(); ++l) {
+    const auto fe_space_p = mg.FeSpace(l);
+    // Dirichlet values at the boundary dofs
+    auto bd_flags{
+        lf::mesh::utils::flagEntitiesOnBoundary(fe_space_p->Mesh(), 1)};
+    auto flag_values{lf::fe::InitEssentialConditionFromFunction(
+        *fe_space_p, bd_flags, mf_g)};
+    Eigen::VectorXd g_vals(flag_values.size());
+    for (std::size_t i = 0; i < flag_values.size(); ++i) {
+      g_vals[i] = flag_values[i].second;
+    }
+    // Warm start from the coarser level
+    if (l > 0) {
+      solutions[l] = mg.Prolongate(l, solutions[l - 1]);
+    }
+    mg.Solve(l, g_vals, solutions[l], tol,
+             infos != nullptr ? &(*infos)[l] : nullptr);
+  }
+  return solutions;
+}
+
 /**
  * @brief Evaluates a finite element function at a point specified by its global
  * coordinates
@@ -249,6 +748,37 @@ double EvaluateFEFunction(
     std::shared_ptr<lf::uscalfe::FeSpaceLagrangeO1<double>> fe_space,
     const Eigen::VectorXd &uFE, Eigen::Vector2d global, double tol = 10E-10);
 
+/**
+ * @brief Evaluates a finite element function at a point specified by its global
+ * coordinates, using a prebuilt spatial index to find the containing cell
+ * @param locator: point locator built for the mesh of fe_space
+ */
+double EvaluateFEFunction(
+    std::shared_ptr<lf::uscalfe::FeSpaceLagrangeO1<double>> fe_space,
+    const Eigen::VectorXd &uFE, const PointLocator &locator,
+    Eigen::Vector2d global, double tol = 10E-10);
+
+/**
+ * @brief Evaluates a finite element function at many points
+ *
+ * The points are grouped by their containing cells, so that the shape
+ * functions of each cell are evaluated once for all points it contains.
+ * @param points: global coordinates of the evaluation points, one per column
+ * @return values of the finite element function at the points, 0.0 for points
+ * outside the mesh
+ */
+Eigen::VectorXd EvaluateFEFunction(
+    std::shared_ptr<lf::uscalfe::FeSpaceLagrangeO1<double>> fe_space,
+    const Eigen::VectorXd &uFE, const Eigen::Matrix2Xd &points,
+    double tol = 10E-10);
+
+/** @brief Same as above, reusing a point locator built for the mesh of
+ * fe_space */
+Eigen::VectorXd EvaluateFEFunction(
+    std::shared_ptr<lf::uscalfe::FeSpaceLagrangeO1<double>> fe_space,
+    const Eigen::VectorXd &uFE, const PointLocator &locator,
+    const Eigen::Matrix2Xd &points, double tol = 10E-10);
+
 /** @brief Returns the result of evaluating u_h(x) directly or by the stable
  * scheme */
 template <typename FUNCTOR>
@@ -273,6 +803,67 @@ std::pair<double, double> ComparePointEval(
   return {direct_eval, stable_eval};
 }
 
+/** @brief Same as above for several evaluation points, solving the BVP only
+ * once with the given linear solver
+ * @param xs: Evaluation points, one per column
+ * @param qr: quadrature rule on the reference triangle for Jstar
+ * @return direct and stable evaluations, one entry per evaluation point
+ */
+template <typename FUNCTOR>
+std::pair<Eigen::VectorXd, Eigen::VectorXd> ComparePointEval(
+    std::shared_ptr<lf::uscalfe::FeSpaceLagrangeO1<double>> fe_space,
+    FUNCTOR &&g, const Eigen::Matrix2Xd &xs,
+    SolverType solver_type = SolverType::kSparseLU,
+    const lf::quad::QuadRule &qr = lf::quad::make_TriaQR_MidpointRule()) {
+  Eigen::VectorXd direct_eval = Eigen::VectorXd::Zero(xs.cols());
+  Eigen::VectorXd stable_eval = Eigen::VectorXd::Zero(xs.cols());
+#if SOLUTION
+  // Compute FE solution:
+  Eigen::VectorXd uFE = SolveBVP(fe_space, g, solver_type);
+
+  // use the two evaluation methods:
+  direct_eval = EvaluateFEFunction(fe_space, uFE, xs);
+  stable_eval = StablePointEvaluation(fe_space, uFE, xs, qr);
+#else
+  //====================
+  // Your code goes here
+  //====================
+#endif
+
+  return {direct_eval, stable_eval};
+}
+
+/** @brief Same as above on all levels of a multigrid hierarchy, solving the
+ * BVP on the levels by nested iteration with SolveBVPMultigrid()
+ * @param mg: multigrid hierarchy, e.g. built from the coarsest mesh of a
+ * convergence study
+ * @return direct and stable evaluations on the levels 0, ..., L
+ */
+template <typename FUNCTOR>
+std::vector<std::pair<Eigen::VectorXd, Eigen::VectorXd>> ComparePointEval(
+    const MultigridHierarchy &mg, FUNCTOR &&g, const Eigen::Matrix2Xd &xs,
+    const lf::quad::QuadRule &qr = lf::quad::make_TriaQR_MidpointRule()) {
+  std::vector<std::pair<Eigen::VectorXd, Eigen::VectorXd>> evals(
+      mg.NumLevels(), {Eigen::VectorXd::Zero(xs.cols()),
+                       Eigen::VectorXd::Zero(xs.cols())});
+#if SOLUTION
+  // Compute FE solutions, each level starting from the coarser one:
+  const std::vector<Eigen::VectorXd> uFE = SolveBVPMultigrid(mg, g);
+
+  // use the two evaluation methods on every level:
+  for (unsigned int l = 0; l < mg.NumLevels(); ++l) {
+    evals[l].first = EvaluateFEFunction(mg.FeSpace(l), uFE[l], xs);
+    evals[l].second = StablePointEvaluation(mg.FeSpace(l), uFE[l], xs, qr);
+  }
+#else
+  //====================
+  // Your code goes here
+  //====================
+#endif
+
+  return evals;
+}
+
 } /* namespace StableEvaluationAtAPoint */
 
 #endif  // STABLE_EVALUATION_AT_A_POINT_H
\ No newline at end of file
@@ -7,34 +7,102 @@
  */
 
 #include <lf/assemble/assemble.h>
-#include <lf/io/io.h>
-#include <lf/mesh/hybrid2d/hybrid2d.h>
 #include <lf/mesh/mesh.h>
+#include <lf/quad/quad.h>
+#include <lf/refinement/refinement.h>
 #include <lf/uscalfe/uscalfe.h>
 
 #include <Eigen/Core>
+#include <algorithm>
 #include <cmath>
 #include <cstdlib>
 #include <fstream>
 #include <iostream>
 #include <memory>
+#include <stdexcept>
 #include <string>
 #include <utility>
+#include <vector>
 
+#include "meshcache.h"
+#include "multigrid.h"
+#include "parallelfor.h"
+#include "profiler.h"
 #include "stableevaluationatapoint.h"
+#include "studyoptions.h"
+#include "unitsquaremesh.h"
+
+int main(int argc, const char **argv) {
+  // Default study: the meshes square1.msh, ..., square6.msh and the
+  // evaluation point (0.3,0.4), see StudyOptionsUsage() for the options
+  StableEvaluationAtAPoint::StudyOptions options;
+  for (int k = 1; k <= 6; ++k) {
+    options.meshes.push_back(CURRENT_SOURCE_DIR "/../meshes/square" +
+                             std::to_string(k) + ".msh");
+  }
+  options.points = Eigen::Vector2d(0.3, 0.4);
+  options.output_dir = CURRENT_BINARY_DIR;
+  try {
+    options = StableEvaluationAtAPoint::ParseStudyOptions(argc, argv, options);
+  } catch (const std::invalid_argument &e) {
+    std::cerr << e.what() << "\n"
+              << StableEvaluationAtAPoint::StudyOptionsUsage(argv[0]);
+    return 1;
+  }
+  if (options.help) {
+    std::cout << StableEvaluationAtAPoint::StudyOptionsUsage(argv[0]);
+    return 0;
+  }
+  StableEvaluationAtAPoint::Profiler::Enable(options.profile);
 
-int main(int /*argc*/, const char ** /*argv*/) {
   // exact solution
   auto uExact = [](Eigen::Vector2d x) -> double {
     Eigen::Vector2d one(1.0, 0.0);
     return std::log((x + one).norm());
   };
-  // Fixed evaluation point
-  Eigen::Vector2d x(0.3, 0.4);
-  std::cout << "Exact evaluation at (0.3,0.4) : " << uExact(x) << std::endl;
+  // Evaluation points
+  const Eigen::Matrix2Xd &xs = options.points;
+  for (Eigen::Index j = 0; j < xs.cols(); ++j) {
+    std::cout << "Exact evaluation at (" << xs(0, j) << "," << xs(1, j)
+              << ") : " << uExact(xs.col(j)) << std::endl;
+  }
 
   // Number of meshes used in the error analysis:
-  int N_meshes = 6;
+  const bool generated = options.meshes.empty();
+  const int N_meshes = static_cast<int>(generated ? options.resolutions.size()
+                                                  : options.meshes.size());
+  if (N_meshes < 2) {
+    std::cerr << "At least two meshes are required\n";
+    return 1;
+  }
+  // Binary copies of the Gmsh files, which load much faster in later runs
+  const std::string mesh_cache_dir = CURRENT_BINARY_DIR "/mesh_cache";
+  // Gauss rule on the boundary edges for the potentials and rule of the same
+  // order on the cells for Jstar
+  const lf::quad::QuadRule qr_gauss =
+      lf::quad::make_QuadRule(lf::base::RefEl::kSegment(), options.quad_order);
+  const lf::quad::QuadRule qr_cells =
+      lf::quad::make_QuadRule(lf::base::RefEl::kTria(), options.quad_order);
+
+  // Geometric multigrid needs nested meshes: the finer levels are obtained by
+  // regular refinement of the first mesh and replace the given ones. The BVPs
+  // on all levels are solved up front by nested iteration.
+  const bool multigrid =
+      options.solver == StableEvaluationAtAPoint::SolverType::kMultigrid;
+  std::unique_ptr<StableEvaluationAtAPoint::MultigridHierarchy> mg;
+  std::vector<std::pair<Eigen::VectorXd, Eigen::VectorXd>> mg_evals;
+  if (multigrid) {
+    std::shared_ptr<lf::mesh::Mesh> coarse_mesh_p =
+        generated ? StableEvaluationAtAPoint::GenerateUnitSquareMesh(
+                        options.resolutions[0], options.perturbation, 0)
+                  : StableEvaluationAtAPoint::LoadMesh(options.meshes[0],
+                                                       mesh_cache_dir);
+    mg = std::make_unique<StableEvaluationAtAPoint::MultigridHierarchy>(
+        lf::refinement::GenerateMeshHierarchyByUniformRefinemnt(coarse_mesh_p,
+                                                                N_meshes - 1));
+    mg_evals = StableEvaluationAtAPoint::ComparePointEval(*mg, uExact, xs,
+                                                          qr_cells);
+  }
 
   // Error analysis vectors:
   Eigen::VectorXd mesh_sizes(N_meshes);
@@ -45,46 +113,87 @@ int main(int /*argc*/, const char ** /*argv*/) {
   // Error vector used for the error analysis in exercise b)
   Eigen::VectorXd errors_potential(N_meshes);
   errors_potential.setZero();
+  // Same with the Gauss rule on the boundary edges
+  Eigen::VectorXd errors_potential_gauss(N_meshes);
+  errors_potential_gauss.setZero();
 
-  // Error vectors used for the error analysis in exercise h
+  // Error vectors used for the error analysis in exercise h, maximum over all
+  // evaluation points
   Eigen::VectorXd errors_direct(N_meshes);
   errors_direct.setZero();
   Eigen::VectorXd errors_stable(N_meshes);
   errors_stable.setZero();
+  // Errors at the individual evaluation points
+  Eigen::MatrixXd errors_direct_points(N_meshes, xs.cols());
+  Eigen::MatrixXd errors_stable_points(N_meshes, xs.cols());
+  // The levels are independent and processed concurrently. Finer meshes
+  // take longer, so they are started first. Mesh files are given from coarse
+  // to fine.
+  std::vector<int> levels(N_meshes);
+  for (int k = 0; k < N_meshes; ++k) {
+    levels[k] = N_meshes - 1 - k;
+  }
+  if (generated && !multigrid) {
+    std::stable_sort(levels.begin(), levels.end(), [&](int k, int l) {
+      return options.resolutions[k] > options.resolutions[l];
+    });
+  }
+  StableEvaluationAtAPoint::ParallelForEachTask(
+      levels, options.num_threads, [&](int k) {
+        std::shared_ptr<lf::uscalfe::FeSpaceLagrangeO1<double>> fe_space;
+        if (multigrid) {
+          fe_space = mg->FeSpace(k);
+        } else {
+          // read or generate mesh::
+          std::shared_ptr<lf::mesh::Mesh> mesh_p =
+              generated ? StableEvaluationAtAPoint::GenerateUnitSquareMesh(
+                              options.resolutions[k], options.perturbation, k)
+                        : StableEvaluationAtAPoint::LoadMesh(
+                              options.meshes[k], mesh_cache_dir);
 
-  // iterate over meshes:
-  for (int k = 0; k < N_meshes; k++) {
-    // read mesh::
-    std::string idx = std::to_string(k + 1);
-    auto mesh_factory = std::make_unique<lf::mesh::hybrid2d::MeshFactory>(2);
-    lf::io::GmshReader reader(std::move(mesh_factory), CURRENT_SOURCE_DIR
-                                                           "/../meshes/square" +
-                                                           idx + ".msh");
-    auto mesh_p = reader.mesh();
-
-    // Initialize fe-space and dofh
-    auto fe_space =
-        std::make_shared<lf::uscalfe::FeSpaceLagrangeO1<double>>(mesh_p);
-    const lf::assemble::DofHandler &dofh = fe_space->LocGlobMap();
-    dofs(k) = dofh.NumDofs();
-
-    // Printing mesh statistics
-    mesh_sizes(k) = StableEvaluationAtAPoint::MeshSize(mesh_p);
-    std::cout << "square" + idx + ".msh: "
-              << "N_dofs = " << dofs(k) << ", h=" << mesh_sizes(k) << std::endl;
+          // Initialize fe-space and dofh
+          fe_space =
+              std::make_shared<lf::uscalfe::FeSpaceLagrangeO1<double>>(mesh_p);
+        }
+        std::shared_ptr<const lf::mesh::Mesh> mesh_p = fe_space->Mesh();
+        const lf::assemble::DofHandler &dofh = fe_space->LocGlobMap();
+        // Every task writes only to its own entries of the result vectors
+        dofs(k) = dofh.NumDofs();
+        mesh_sizes(k) = StableEvaluationAtAPoint::MeshSize(mesh_p);
+
+        // Error anlysis part b) (Potentials)
+        errors_potential(k) = StableEvaluationAtAPoint::PointEval(mesh_p);
+        errors_potential_gauss(k) =
+            StableEvaluationAtAPoint::PointEval(mesh_p, qr_gauss);
 
-    // Error anlysis part b) (Potentials)
-    errors_potential(k) = StableEvaluationAtAPoint::PointEval(mesh_p);
+        // error analysis part g/h: Compare direct vs stable point evaluation:
+        auto [direct_eval, stable_eval] =
+            multigrid ? mg_evals[k]
+                      : StableEvaluationAtAPoint::ComparePointEval(
+                            fe_space, uExact, xs, options.solver, qr_cells);
+        for (Eigen::Index j = 0; j < xs.cols(); ++j) {
+          errors_direct_points(k, j) =
+              std::abs(uExact(xs.col(j)) - direct_eval[j]);
+          errors_stable_points(k, j) =
+              std::abs(uExact(xs.col(j)) - stable_eval[j]);
+        }
+        errors_direct(k) = errors_direct_points.row(k).maxCoeff();
+        errors_stable(k) = errors_stable_points.row(k).maxCoeff();
+      });
 
-    // error analysis part g/h: Compare direct vs stable point evaluation:
-    auto [direct_eval, stable_eval] =
-        StableEvaluationAtAPoint::ComparePointEval(fe_space, uExact, x);
-    errors_direct(k) = std::abs(uExact(x) - direct_eval);
-    errors_stable(k) = std::abs(uExact(x) - stable_eval);
+  // Printing mesh statistics
+  for (int k = 0; k < N_meshes; k++) {
+    const std::string name =
+        multigrid   ? "level " + std::to_string(k)
+        : generated ? "n=" + std::to_string(options.resolutions[k])
+                    : options.meshes[k];
+    std::cout << name << ": "
+              << "N_dofs = " << dofs(k) << ", h=" << mesh_sizes(k) << std::endl;
   }
 
   // Compute rates of convergence:
   Eigen::VectorXd rates_potential(N_meshes - 1);
+  Eigen::VectorXd rates_potential_gauss(N_meshes - 1);
   Eigen::VectorXd rates_direct(N_meshes - 1);
   Eigen::VectorXd rates_stable(N_meshes - 1);
 
@@ -93,6 +202,9 @@ int main(int /*argc*/, const char ** /*argv*/) {
     double log_denum = std::log(mesh_sizes(k) / mesh_sizes(k + 1));
     rates_potential(k) =
         std::log(errors_potential(k) / errors_potential(k + 1)) / log_denum;
+    rates_potential_gauss(k) = std::log(errors_potential_gauss(k) /
+                                        errors_potential_gauss(k + 1)) /
+                               log_denum;
     rates_direct(k) =
         std::log(errors_direct(k) / errors_direct(k + 1)) / log_denum;
     rates_stable(k) =
@@ -108,6 +220,8 @@ int main(int /*argc*/, const char ** /*argv*/) {
   std::cout << "Subtask b) Evaluation based on Potentials \n";
   std::cout << "Errors: \n" << errors_potential << "\n";
   std::cout << "Rates: \n" << rates_potential << "\n";
+  std::cout << "Errors (Gauss rule): \n" << errors_potential_gauss << "\n";
+  std::cout << "Rates (Gauss rule): \n" << rates_potential_gauss << "\n";
   std::cout << "Subtask h) Comparison of direct and stable evaluation: \n";
   std::cout << "Errors direct: \n" << errors_direct << "\n";
   std::cout << "Rates direct: \n" << rates_direct << "\n";
@@ -118,32 +232,57 @@ int main(int /*argc*/, const char ** /*argv*/) {
   const static Eigen::IOFormat CSVFormat(Eigen::StreamPrecision,
                                          Eigen::DontAlignCols, ", ", "\n");
 
-  Eigen::MatrixXd convergence_potential(N_meshes, 2);
-  convergence_potential << mesh_sizes, errors_potential;
+  Eigen::MatrixXd convergence_potential(N_meshes, 3);
+  convergence_potential << mesh_sizes, errors_potential,
+      errors_potential_gauss;
 
   Eigen::MatrixXd convergence_stable(N_meshes, 3);
   convergence_stable << mesh_sizes, errors_direct, errors_stable;
 
+  const std::string &dir = options.output_dir;
   std::ofstream file;
-  file.open("convergence_potential.csv");
-  file << "h, Error u(x) (Potential) \n";
+  file.open(dir + "/convergence_potential.csv");
+  file << "h, Error u(x) (Potential), Error u(x) (Potential, Gauss) \n";
   file << convergence_potential.format(CSVFormat);
   file.close();
-  std::cout << "Generated " CURRENT_BINARY_DIR "/convergence_potential.csv"
+  std::cout << "Generated " << dir << "/convergence_potential.csv"
             << std::endl;
 
-  file.open("convergence_stable.csv");
+  file.open(dir + "/convergence_stable.csv");
   file << "h, Error u(x) (Direct), Error u(x) (Stable) \n";
   file << convergence_stable.format(CSVFormat);
   file.close();
-  std::cout << "Generated " CURRENT_BINARY_DIR "/convergence_stable.csv"
-            << std::endl;
+  std::cout << "Generated " << dir << "/convergence_stable.csv" << std::endl;
+
+  // Errors at every evaluation point
+  file.open(dir + "/convergence_points.csv");
+  file << "h, x, y, Error u(x) (Direct), Error u(x) (Stable) \n";
+  for (int k = 0; k < N_meshes; ++k) {
+    for (Eigen::Index j = 0; j < xs.cols(); ++j) {
+      file << mesh_sizes(k) << ", " << xs(0, j) << ", " << xs(1, j) << ", "
+           << errors_direct_points(k, j) << ", " << errors_stable_points(k, j)
+           << "\n";
+    }
+  }
+  file.close();
+  std::cout << "Generated " << dir << "/convergence_points.csv" << std::endl;
+
+  // Cost of the stages, summed over all threads
+  if (options.profile) {
+    StableEvaluationAtAPoint::Profiler::PrintTable(std::cout);
+    file.open(dir + "/profile.json");
+    StableEvaluationAtAPoint::Profiler::PrintJSON(file);
+    file.close();
+    std::cout << "Generated " << dir << "/profile.json" << std::endl;
+  }
 
   // Plot
-  std::system("python3 " CURRENT_SOURCE_DIR
-              "/plot_convergence_potential.py " CURRENT_BINARY_DIR);
-  std::system("python3 " CURRENT_SOURCE_DIR
-              "/plot_convergence_stable.py " CURRENT_BINARY_DIR);
+  if (options.plot) {
+    const std::string script =
+        "python3 " CURRENT_SOURCE_DIR "/plot_convergence";
+    std::system((script + "_potential.py " + dir).c_str());
+    std::system((script + "_stable.py " + dir).c_str());
+  }
 
   return 0;
 }
@@ -0,0 +1,187 @@
+/**
+ * @file studyoptions.cc
+ * @brief NPDE homework StableEvaluationAtAPoint
+ * @author Amélie Loher, Erick Schulz & Philippe Peter
+ * @date 29.11.2021
+ * @copyright Developed at ETH Zurich
+ */
+
+#include "studyoptions.h"
+
+#include <Eigen/Core>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace StableEvaluationAtAPoint {
+
+namespace {
+
+// The whole string must be a number
+double ToDouble(const std::string &option, const std::string &value) {
+  std::size_t end = 0;
+  double number = 0.0;
+  try {
+    number = std::stod(value, &end);
+  } catch (const std::logic_error &) {
+    end = 0;
+  }
+  if (end == 0 || end != value.size()) {
+    throw std::invalid_argument("Invalid value '" + value + "' of " + option);
+  }
+  return number;
+}
+
+unsigned int ToUnsigned(const std::string &option, const std::string &value) {
+  std::size_t end = 0;
+  unsigned long number = 0;
+  try {
+    number = std::stoul(value, &end);
+  } catch (const std::logic_error &) {
+    end = 0;
+  }
+  if (end == 0 || end != value.size() || value[0] == '-' ||
+      number > 0xFFFFFFFFul) {
+    throw std::invalid_argument("Invalid value '" + value + "' of " + option);
+  }
+  return static_cast<unsigned int>(number);
+}
+
+}  // namespace
+
+SolverType ParseSolverType(const std::string &name) {
+  if (name == "lu") {
+    return SolverType::kSparseLU;
+  }
+  if (name == "ldlt") {
+    return SolverType::kSimplicialLDLT;
+  }
+  if (name == "cg-jacobi") {
+    return SolverType::kCGJacobi;
+  }
+  if (name == "cg-ic") {
+    return SolverType::kCGIncompleteCholesky;
+  }
+  if (name == "cg-amg") {
+    return SolverType::kCGAMG;
+  }
+  if (name == "mg") {
+    return SolverType::kMultigrid;
+  }
+  throw std::invalid_argument("Unknown solver '" + name + "'");
+}
+
+StudyOptions ParseStudyOptions(int argc, const char *const *argv,
+                               const StudyOptions &defaults) {
+  StudyOptions options = defaults;
+  bool meshes_given = false;
+  bool resolutions_given = false;
+  std::vector<Eigen::Vector2d> points;
+  for (int i = 1; i < argc; ++i) {
+    const std::string option = argv[i];
+    // Options without a value
+    if (option == "-h" || option == "--help") {
+      options.help = true;
+      continue;
+    }
+    if (option == "--no-plot") {
+      options.plot = false;
+      continue;
+    }
+    if (option == "--profile") {
+      options.profile = true;
+      continue;
+    }
+    if (i + 1 == argc) {
+      throw std::invalid_argument("Missing value of " + option);
+    }
+    const std::string value = argv[++i];
+    if (option == "--mesh") {
+      if (!meshes_given) {
+        options.meshes.clear();
+        meshes_given = true;
+      }
+      options.meshes.push_back(value);
+    } else if (option == "--resolution") {
+      if (!resolutions_given) {
+        options.resolutions.clear();
+        resolutions_given = true;
+      }
+      const unsigned int n = ToUnsigned(option, value);
+      if (n == 0) {
+        throw std::invalid_argument("Resolution must be positive");
+      }
+      options.resolutions.push_back(n);
+    } else if (option == "--perturbation") {
+      options.perturbation = ToDouble(option, value);
+      if (options.perturbation < 0.0 || options.perturbation >= 0.25) {
+        throw std::invalid_argument("Perturbation must lie in [0, 0.25)");
+      }
+    } else if (option == "--point") {
+      const std::size_t comma = value.find(',');
+      if (comma == std::string::npos) {
+        throw std::invalid_argument("Point '" + value + "' is not x,y");
+      }
+      points.emplace_back(ToDouble(option, value.substr(0, comma)),
+                          ToDouble(option, value.substr(comma + 1)));
+    } else if (option == "--solver") {
+      options.solver = ParseSolverType(value);
+    } else if (option == "--quad-order") {
+      options.quad_order = ToUnsigned(option, value);
+      if (options.quad_order == 0) {
+        throw std::invalid_argument("Quadrature order must be positive");
+      }
+    } else if (option == "--threads") {
+      options.num_threads = ToUnsigned(option, value);
+    } else if (option == "--output-dir") {
+      options.output_dir = value;
+    } else {
+      throw std::invalid_argument("Unknown option " + option);
+    }
+  }
+  if (!options.meshes.empty() && !options.resolutions.empty() &&
+      (meshes_given || resolutions_given)) {
+    // Explicitly given levels replace the default levels of the other kind
+    if (!meshes_given) {
+      options.meshes.clear();
+    } else if (!resolutions_given) {
+      options.resolutions.clear();
+    } else {
+      throw std::invalid_argument("Either --mesh or --resolution");
+    }
+  }
+  if (!points.empty()) {
+    options.points.resize(2, points.size());
+    for (std::size_t k = 0; k < points.size(); ++k) {
+      options.points.col(k) = points[k];
+    }
+  }
+  return options;
+}
+
+std::string StudyOptionsUsage(const std::string &program) {
+  return "Usage: " + program +
+         " [options]\n"
+         "Convergence study of the evaluation of FE solutions at points\n"
+         "  --mesh FILE          Gmsh file of a mesh of the unit square,\n"
+         "                       repeated for the levels from coarse to fine\n"
+         "  --resolution N       generated mesh with 2 N^2 triangles instead,\n"
+         "                       repeated for the levels\n"
+         "  --perturbation P     random perturbation of the generated nodes,\n"
+         "                       relative to the mesh width, P < 0.25\n"
+         "  --point X,Y          evaluation point, repeated for several\n"
+         "  --solver NAME        lu, ldlt, cg-jacobi, cg-ic, cg-amg or mg,\n"
+         "                       mg refines the first mesh regularly to\n"
+         "                       obtain the finer levels\n"
+         "  --quad-order Q       order of the quadrature rules for the\n"
+         "                       potentials (edges) and Jstar (cells)\n"
+         "  --threads T          number of threads, 0 for all cores\n"
+         "  --output-dir DIR     directory of the CSV files and plots\n"
+         "  --no-plot            do not call the plot scripts\n"
+         "  --profile            report time and counters per stage, also\n"
+         "                       written to profile.json\n"
+         "  -h, --help           print this message\n";
+}
+
+}  // namespace StableEvaluationAtAPoint
@@ -0,0 +1,65 @@
+#ifndef STUDY_OPTIONS_H
+#define STUDY_OPTIONS_H
+
+/**
+ * @file studyoptions.h
+ * @brief NPDE homework StableEvaluationAtAPoint
+ * @author Amélie Loher, Erick Schulz & Philippe Peter
+ * @date 29.11.2021
+ * @copyright Developed at ETH Zurich
+ */
+
+#include <Eigen/Core>
+#include <string>
+#include <vector>
+
+#include "linearsolver.h"
+
+namespace StableEvaluationAtAPoint {
+
+/** @brief Parameters of the convergence study run by the main program */
+struct StudyOptions {
+  // Gmsh files of the mesh levels, ordered from coarse to fine
+  std::vector<std::string> meshes;
+  // Alternatively, resolutions n of meshes from GenerateUnitSquareMesh()
+  std::vector<unsigned int> resolutions;
+  // Perturbation of the generated meshes
+  double perturbation = 0.0;
+  // Points at which the FE solutions are evaluated, one per column
+  Eigen::Matrix2Xd points;
+  SolverType solver = SolverType::kSparseLU;
+  // Order of the quadrature rules for the potentials on the boundary edges
+  // and for Jstar on the cells
+  unsigned int quad_order = 3;
+  // Number of threads, 0 selects the number of hardware threads
+  unsigned int num_threads = 0;
+  // Directory of the CSV files and plots
+  std::string output_dir = ".";
+  bool plot = true;
+  // Record the cost of the stages of the computation, see Profiler
+  bool profile = false;
+  bool help = false;
+};
+
+/** @brief Parses the command line arguments of the main program
+ *
+ * Options that are not given keep the values of defaults. Repeated options
+ * --mesh, --resolution and --point add to the list given by the defaults, or
+ * replace it on the first occurrence.
+ * @throw std::invalid_argument for unknown options and invalid values
+ */
+StudyOptions ParseStudyOptions(int argc, const char *const *argv,
+                               const StudyOptions &defaults = {});
+
+/** @brief Description of the command line options */
+std::string StudyOptionsUsage(const std::string &program);
+
+/** @brief Solver type from one of the names lu, ldlt, cg-jacobi, cg-ic,
+ * cg-amg and mg
+ * @throw std::invalid_argument for other names
+ */
+SolverType ParseSolverType(const std::string &name);
+
+}  // namespace StableEvaluationAtAPoint
+
+#endif  // STUDY_OPTIONS_H
@@ -9,6 +9,21 @@
 set(SOURCES
   ${DIR}/test/stableevaluationatapoint_test.cc
   ${DIR}/stableevaluationatapoint.cc
+  ${DIR}/pointlocator.cc
+  ${DIR}/boundaryquadraturecache.cc
+  ${DIR}/boundarytreecode.cc
+  ${DIR}/linearsolver.cc
+  ${DIR}/amgpreconditioner.cc
+  ${DIR}/multigrid.cc
+  ${DIR}/gaussseidel.cc
+  ${DIR}/dirichletsolver.cc
+  ${DIR}/csrassembler.cc
+  ${DIR}/reducedsystem.cc
+  ${DIR}/meshcache.cc
+  ${DIR}/unitsquaremesh.cc
+  ${DIR}/studyoptions.cc
+  ${DIR}/profiler.cc
+  ${DIR}/trianglegeometry.cc
 )
 
 set(LIBRARIES
@@ -23,6 +38,8 @@ set(LIBRARIES
   LF::lf.mesh.hybrid2d
   LF::lf.mesh.utils
   LF::lf.quad
+  LF::lf.refinement
   LF::lf.uscalfe
+  Threads::Threads
 )
 
@@ -10,22 +10,38 @@
 
 #include <gtest/gtest.h>
 #include <lf/fe/fe.h>
+#include <lf/geometry/geometry.h>
 #include <lf/io/io.h>
 #include <lf/mesh/hybrid2d/hybrid2d.h>
 #include <lf/mesh/mesh.h>
 #include <lf/mesh/utils/utils.h>
+#include <lf/quad/quad.h>
+#include <lf/refinement/refinement.h>
 #include <lf/uscalfe/uscalfe.h>
 
 #include <Eigen/Core>
+#include <algorithm>
+#include <array>
 #include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
 #include <memory>
+#include <stdexcept>
+#include <string>
 #include <utility>
+#include <vector>
+
+#include "../boundarytreecode.h"
+#include "../meshcache.h"
+#include "../profiler.h"
+#include "../studyoptions.h"
+#include "../trianglegeometry.h"
+#include "../unitsquaremesh.h"
 
 TEST(StableEvaluationAtAPoint, PSL) {
-  auto mesh_factory_init = std::make_unique<lf::mesh::hybrid2d::MeshFactory>(2);
-  lf::io::GmshReader reader_init(std::move(mesh_factory_init),
-                                 CURRENT_SOURCE_DIR "/../../meshes/square.msh");
-  std::shared_ptr<lf::mesh::Mesh> mesh_p = reader_init.mesh();
+  std::shared_ptr<lf::mesh::Mesh> mesh_p = StableEvaluationAtAPoint::LoadMesh(
+      CURRENT_SOURCE_DIR "/../../meshes/square.msh");
 
   const auto u = [](Eigen::Vector2d x) -> double {
     Eigen::Vector2d one(1.0, 0.0);
@@ -44,10 +60,8 @@ TEST(StableEvaluationAtAPoint, PSL) {
 }
 
 TEST(StableEvaluationAtAPoint, PDL) {
-  auto mesh_factory_init = std::make_unique<lf::mesh::hybrid2d::MeshFactory>(2);
-  lf::io::GmshReader reader_init(std::move(mesh_factory_init),
-                                 CURRENT_SOURCE_DIR "/../../meshes/square.msh");
-  std::shared_ptr<lf::mesh::Mesh> mesh_p = reader_init.mesh();
+  std::shared_ptr<lf::mesh::Mesh> mesh_p = StableEvaluationAtAPoint::LoadMesh(
+      CURRENT_SOURCE_DIR "/../../meshes/square.msh");
 
   const auto u = [](Eigen::Vector2d x) -> double {
     Eigen::Vector2d one(1.0, 0.0);
@@ -66,10 +80,8 @@ TEST(StableEvaluationAtAPoint, PDL) {
 }
 
 TEST(StableEvaluationAtAPoint, PointEval) {
-  auto mesh_factory_init = std::make_unique<lf::mesh::hybrid2d::MeshFactory>(2);
-  lf::io::GmshReader reader_init(std::move(mesh_factory_init),
-                                 CURRENT_SOURCE_DIR "/../../meshes/square.msh");
-  std::shared_ptr<lf::mesh::Mesh> mesh_p = reader_init.mesh();
+  std::shared_ptr<lf::mesh::Mesh> mesh_p = StableEvaluationAtAPoint::LoadMesh(
+      CURRENT_SOURCE_DIR "/../../meshes/square.msh");
 
   double error = StableEvaluationAtAPoint::PointEval(mesh_p);
 
@@ -81,11 +93,8 @@ TEST(StableEvaluationAtAPoint, PointEval) {
 }
 
 TEST(StableEvaluationAtAPoint, Jstar) {
-  auto mesh_factory_init = std::make_unique<lf::mesh::hybrid2d::MeshFactory>(2);
-  lf::io::GmshReader reader_init(std::move(mesh_factory_init),
-                                 CURRENT_SOURCE_DIR
-                                 "/../../meshes/square7.msh");
-  std::shared_ptr<lf::mesh::Mesh> mesh_p = reader_init.mesh();
+  std::shared_ptr<lf::mesh::Mesh> mesh_p = StableEvaluationAtAPoint::LoadMesh(
+      CURRENT_SOURCE_DIR "/../../meshes/square7.msh");
 
   std::shared_ptr<lf::uscalfe::FeSpaceLagrangeO1<double>> fe_space =
       std::make_shared<lf::uscalfe::FeSpaceLagrangeO1<double>>(mesh_p);
@@ -109,12 +118,904 @@ TEST(StableEvaluationAtAPoint, Jstar) {
   ASSERT_NEAR(val, ref_val, tol);
 }
 
+TEST(StableEvaluationAtAPoint, JstarTransitionZone) {
+  std::shared_ptr<lf::mesh::Mesh> mesh_p = StableEvaluationAtAPoint::LoadMesh(
+      CURRENT_SOURCE_DIR "/../../meshes/square3.msh");
+
+  std::shared_ptr<lf::uscalfe::FeSpaceLagrangeO1<double>> fe_space =
+      std::make_shared<lf::uscalfe::FeSpaceLagrangeO1<double>>(mesh_p);
+
+  const auto u = [](Eigen::Vector2d x) -> double {
+    Eigen::Vector2d one(1.0, 0.0);
+    return std::log((x + one).norm());
+  };
+  lf::mesh::utils::MeshFunctionGlobal mf_u{u};
+  Eigen::VectorXd uFE = lf::fe::NodalProjection(*fe_space, mf_u);
+
+  const Eigen::Vector2d x(0.3, 0.4);
+
+  StableEvaluationAtAPoint::Psi psi(Eigen::Vector2d(0.5, 0.5));
+  std::vector<const lf::mesh::Entity *> cells =
+      StableEvaluationAtAPoint::TransitionZoneCells(mesh_p, psi);
+  std::vector<const lf::mesh::Entity *> all_cells(
+      mesh_p->Entities(0).begin(), mesh_p->Entities(0).end());
+  ASSERT_LT(cells.size(), all_cells.size());
+
+  // Skipped cells contribute exact zeros, so the results agree bitwise
+  double val = StableEvaluationAtAPoint::Jstar(fe_space, uFE, x, cells);
+  double ref_val = StableEvaluationAtAPoint::Jstar(fe_space, uFE, x, all_cells);
+
+  ASSERT_EQ(val, ref_val);
+}
+
+TEST(StableEvaluationAtAPoint, JstarQuadrature) {
+  std::shared_ptr<lf::mesh::Mesh> mesh_p = StableEvaluationAtAPoint::LoadMesh(
+      CURRENT_SOURCE_DIR "/../../meshes/square3.msh");
+
+  std::shared_ptr<lf::uscalfe::FeSpaceLagrangeO1<double>> fe_space =
+      std::make_shared<lf::uscalfe::FeSpaceLagrangeO1<double>>(mesh_p);
+
+  const auto u = [](Eigen::Vector2d x) -> double {
+    Eigen::Vector2d one(1.0, 0.0);
+    return std::log((x + one).norm());
+  };
+  lf::mesh::utils::MeshFunctionGlobal mf_u{u};
+  Eigen::VectorXd uFE = lf::fe::NodalProjection(*fe_space, mf_u);
+
+  const Eigen::Vector2d x(0.3, 0.4);
+
+  // The midpoint rule reproduces the default
+  double val_mp = StableEvaluationAtAPoint::Jstar(
+      fe_space, uFE, x, lf::quad::make_TriaQR_MidpointRule());
+  ASSERT_EQ(val_mp, StableEvaluationAtAPoint::Jstar(fe_space, uFE, x));
+
+  // Adaptive quadrature converges for decreasing tolerances
+  double val_1 =
+      StableEvaluationAtAPoint::JstarAdaptive(fe_space, uFE, x, 1.e-7);
+  double val_2 =
+      StableEvaluationAtAPoint::JstarAdaptive(fe_space, uFE, x, 1.e-9);
+  ASSERT_NEAR(val_1, val_2, 1.e-6);
+
+  // Quadrature of higher degree approaches the adaptive value
+  double val_hi = StableEvaluationAtAPoint::Jstar(
+      fe_space, uFE, x, lf::quad::make_QuadRule(lf::base::RefEl::kTria(), 8));
+  ASSERT_LT(std::abs(val_hi - val_2), std::abs(val_mp - val_2));
+}
+
+TEST(StableEvaluationAtAPoint, JstarMulti) {
+  std::shared_ptr<lf::mesh::Mesh> mesh_p = StableEvaluationAtAPoint::LoadMesh(
+      CURRENT_SOURCE_DIR "/../../meshes/square3.msh");
+
+  std::shared_ptr<lf::uscalfe::FeSpaceLagrangeO1<double>> fe_space =
+      std::make_shared<lf::uscalfe::FeSpaceLagrangeO1<double>>(mesh_p);
+
+  const auto u = [](Eigen::Vector2d x) -> double {
+    Eigen::Vector2d one(1.0, 0.0);
+    return std::log((x + one).norm());
+  };
+  lf::mesh::utils::MeshFunctionGlobal mf_u{u};
+  Eigen::VectorXd uFE = lf::fe::NodalProjection(*fe_space, mf_u);
+
+  Eigen::Matrix2Xd xs(2, 4);
+  xs << 0.3, 0.5, 0.6, 0.45,  //
+      0.4, 0.5, 0.55, 0.3;
+
+  Eigen::VectorXd vals =
+      StableEvaluationAtAPoint::JstarMulti(fe_space, uFE, xs);
+
+  double tol = 1.e-10;
+
+  ASSERT_EQ(vals.size(), xs.cols());
+  for (int i = 0; i < xs.cols(); ++i) {
+    double ref_val = StableEvaluationAtAPoint::Jstar(fe_space, uFE, xs.col(i));
+    ASSERT_NEAR(vals(i), ref_val, tol);
+  }
+
+  // The multi-point StablePointEvaluation agrees with the single-point one
+  // for a higher order rule and skips points violating the assumptions
+  const lf::quad::QuadRule qr =
+      lf::quad::make_QuadRule(lf::base::RefEl::kTria(), 3);
+  Eigen::Matrix2Xd xs_all(2, xs.cols() + 1);
+  xs_all << xs, Eigen::Vector2d(0.9, 0.1);
+  const Eigen::VectorXd stable_vals =
+      StableEvaluationAtAPoint::StablePointEvaluation(fe_space, uFE, xs_all,
+                                                      qr);
+  ASSERT_EQ(stable_vals.size(), xs_all.cols());
+  for (int i = 0; i < xs.cols(); ++i) {
+    ASSERT_NEAR(stable_vals(i),
+                StableEvaluationAtAPoint::StablePointEvaluation(
+                    fe_space, uFE, xs.col(i), qr),
+                tol);
+  }
+  ASSERT_EQ(stable_vals(xs.cols()), 0.0);
+}
+
+TEST(StableEvaluationAtAPoint, JstarFunctional) {
+  std::shared_ptr<lf::mesh::Mesh> mesh_p = StableEvaluationAtAPoint::LoadMesh(
+      CURRENT_SOURCE_DIR "/../../meshes/square3.msh");
+
+  std::shared_ptr<lf::uscalfe::FeSpaceLagrangeO1<double>> fe_space =
+      std::make_shared<lf::uscalfe::FeSpaceLagrangeO1<double>>(mesh_p);
+
+  const auto u = [](Eigen::Vector2d x) -> double {
+    Eigen::Vector2d one(1.0, 0.0);
+    return std::log((x + one).norm());
+  };
+  lf::mesh::utils::MeshFunctionGlobal mf_u{u};
+  Eigen::VectorXd uFE = lf::fe::NodalProjection(*fe_space, mf_u);
+
+  Eigen::Matrix2Xd xs(2, 3);
+  xs << 0.3, 0.5, 0.6,  //
+      0.4, 0.5, 0.55;
+
+  Eigen::MatrixXd W =
+      StableEvaluationAtAPoint::JstarFunctionalMatrix(fe_space, xs);
+
+  double tol = 1.e-10;
+
+  for (int i = 0; i < xs.cols(); ++i) {
+    double ref_val = StableEvaluationAtAPoint::Jstar(fe_space, uFE, xs.col(i));
+    Eigen::VectorXd w_x =
+        StableEvaluationAtAPoint::JstarFunctional(fe_space, xs.col(i));
+    ASSERT_NEAR(w_x.dot(uFE), ref_val, tol);
+    ASSERT_NEAR((W.row(i).transpose() - w_x).norm(), 0.0, tol);
+  }
+}
+
+TEST(StableEvaluationAtAPoint, EvaluateFEFunctionLocator) {
+  std::shared_ptr<lf::mesh::Mesh> mesh_p = StableEvaluationAtAPoint::LoadMesh(
+      CURRENT_SOURCE_DIR "/../../meshes/square.msh");
+
+  std::shared_ptr<lf::uscalfe::FeSpaceLagrangeO1<double>> fe_space =
+      std::make_shared<lf::uscalfe::FeSpaceLagrangeO1<double>>(mesh_p);
+
+  const auto u = [](Eigen::Vector2d x) -> double {
+    Eigen::Vector2d one(1.0, 0.0);
+    return std::log((x + one).norm());
+  };
+  lf::mesh::utils::MeshFunctionGlobal mf_u{u};
+  Eigen::VectorXd uFE = lf::fe::NodalProjection(*fe_space, mf_u);
+
+  StableEvaluationAtAPoint::PointLocator locator(mesh_p);
+
+  double tol = 1.e-12;
+
+  // Interior points, points on the boundary and corners of the square
+  Eigen::MatrixXd points(2, 6);
+  points << 0.3, 0.5, 0.91, 0.0, 1.0, 0.25,  //
+      0.4, 0.5, 0.07, 0.0, 1.0, 1.0;
+  for (int i = 0; i < points.cols(); ++i) {
+    const Eigen::Vector2d x = points.col(i);
+    double val = StableEvaluationAtAPoint::EvaluateFEFunction(fe_space, uFE,
+                                                              locator, x);
+    double ref_val =
+        StableEvaluationAtAPoint::EvaluateFEFunction(fe_space, uFE, x);
+    ASSERT_NEAR(val, ref_val, tol);
+  }
+
+  // Points outside the square are not located
+  ASSERT_EQ(locator.Locate(Eigen::Vector2d(1.5, 0.5)).first, nullptr);
+}
+
+TEST(StableEvaluationAtAPoint, EvaluateFEFunctionBatched) {
+  std::shared_ptr<lf::mesh::Mesh> mesh_p = StableEvaluationAtAPoint::LoadMesh(
+      CURRENT_SOURCE_DIR "/../../meshes/square.msh");
+
+  std::shared_ptr<lf::uscalfe::FeSpaceLagrangeO1<double>> fe_space =
+      std::make_shared<lf::uscalfe::FeSpaceLagrangeO1<double>>(mesh_p);
+
+  const auto u = [](Eigen::Vector2d x) -> double {
+    Eigen::Vector2d one(1.0, 0.0);
+    return std::log((x + one).norm());
+  };
+  lf::mesh::utils::MeshFunctionGlobal mf_u{u};
+  Eigen::VectorXd uFE = lf::fe::NodalProjection(*fe_space, mf_u);
+
+  // Grid of points, including boundary points and one outside the square
+  const int n = 17;
+  Eigen::Matrix2Xd points(2, n * n + 1);
+  for (int i = 0; i < n; ++i) {
+    for (int j = 0; j < n; ++j) {
+      points.col(i * n + j) << i / (n - 1.0), j / (n - 1.0);
+    }
+  }
+  points.col(n * n) << 1.5, 0.5;
+
+  Eigen::VectorXd vals =
+      StableEvaluationAtAPoint::EvaluateFEFunction(fe_space, uFE, points);
+
+  double tol = 1.e-12;
+
+  ASSERT_EQ(vals.size(), points.cols());
+  for (int i = 0; i < points.cols(); ++i) {
+    double ref_val = StableEvaluationAtAPoint::EvaluateFEFunction(
+        fe_space, uFE, Eigen::Vector2d(points.col(i)));
+    ASSERT_NEAR(vals(i), ref_val, tol);
+  }
+}
+
+TEST(StableEvaluationAtAPoint, BoundaryQuadratureCache) {
+  std::shared_ptr<lf::mesh::Mesh> mesh_p = StableEvaluationAtAPoint::LoadMesh(
+      CURRENT_SOURCE_DIR "/../../meshes/square.msh");
+
+  const StableEvaluationAtAPoint::BoundaryQuadratureCache cache(mesh_p);
+
+  // The normals of the cache coincide with those of the unit square
+  for (Eigen::Index l = 0; l < cache.NumPoints(); ++l) {
+    const Eigen::Vector2d n = StableEvaluationAtAPoint::OuterNormalUnitSquare(
+        cache.Points().col(l));
+    ASSERT_NEAR((cache.Normals().col(l) - n).norm(), 0.0, 1.e-12);
+  }
+  ASSERT_NEAR(cache.Weights().sum(), 4.0, 1.e-12);
+
+  const auto u = [](Eigen::Vector2d x) -> double {
+    Eigen::Vector2d one(1.0, 0.0);
+    return std::log((x + one).norm());
+  };
+
+  const Eigen::Vector2d x(0.3, 0.4);
+
+  double tol = 1.e-12;
+
+  // Without near-field refinement the midpoint rule of the cache reproduces
+  // PSL and PDL
+  const StableEvaluationAtAPoint::BoundaryQuadratureCache plain_cache(
+      mesh_p, lf::quad::make_QuadRule(lf::base::RefEl::kSegment(), 1), 0.0);
+  ASSERT_NEAR(StableEvaluationAtAPoint::PSL(plain_cache, u, x),
+              StableEvaluationAtAPoint::PSL(mesh_p, u, x), tol);
+  ASSERT_NEAR(StableEvaluationAtAPoint::PDL(plain_cache, u, x),
+              StableEvaluationAtAPoint::PDL(mesh_p, u, x), tol);
+  ASSERT_NEAR(StableEvaluationAtAPoint::PSLMulti(cache, u, x)[0],
+              StableEvaluationAtAPoint::PSL(mesh_p, u, x), tol);
+  ASSERT_NEAR(StableEvaluationAtAPoint::PDLMulti(cache, u, x)[0],
+              StableEvaluationAtAPoint::PDL(mesh_p, u, x), tol);
+}
+
+TEST(StableEvaluationAtAPoint, PointEvalGauss) {
+  std::shared_ptr<lf::mesh::Mesh> mesh_p = StableEvaluationAtAPoint::LoadMesh(
+      CURRENT_SOURCE_DIR "/../../meshes/square.msh");
+
+  // Gauss rules are more accurate than the midpoint rule. On square.msh with
+  // one edge per side the errors are 0.078, 0.013 and 0.0024 for one, two
+  // and three points.
+  const double error_midpoint = StableEvaluationAtAPoint::PointEval(mesh_p);
+  const double error_gauss2 = StableEvaluationAtAPoint::PointEval(
+      mesh_p, lf::quad::make_QuadRule(lf::base::RefEl::kSegment(), 3));
+  const double error_gauss3 = StableEvaluationAtAPoint::PointEval(
+      mesh_p, lf::quad::make_QuadRule(lf::base::RefEl::kSegment(), 5));
+  ASSERT_LT(error_gauss2, 0.25 * error_midpoint);
+  ASSERT_LT(error_gauss3, 0.1 * error_midpoint);
+}
+
+TEST(StableEvaluationAtAPoint, PSLPDLNearBoundary) {
+  std::shared_ptr<lf::mesh::Mesh> mesh_p = StableEvaluationAtAPoint::LoadMesh(
+      CURRENT_SOURCE_DIR "/../../meshes/square.msh");
+
+  const StableEvaluationAtAPoint::BoundaryQuadratureCache cache(
+      mesh_p, lf::quad::make_QuadRule(lf::base::RefEl::kSegment(), 5));
+
+  const auto u = [](Eigen::Vector2d x) -> double {
+    Eigen::Vector2d one(1.0, 0.0);
+    return std::log((x + one).norm());
+  };
+  const auto gradu_dot_n = [](Eigen::Vector2d x) -> double {
+    Eigen::Vector2d one(1.0, 0.0);
+    return ((x + one) / (x + one).squaredNorm())
+        .dot(StableEvaluationAtAPoint::OuterNormalUnitSquare(x));
+  };
+
+  // Representation formula at points approaching the boundary
+  for (double d : {1.e-2, 1.e-4, 1.e-6}) {
+    const Eigen::Vector2d x(0.37, d);
+    const double rhs = StableEvaluationAtAPoint::PSL(cache, gradu_dot_n, x) -
+                       StableEvaluationAtAPoint::PDL(cache, u, x);
+    ASSERT_NEAR(rhs, u(x), 1.e-4);
+  }
+}
+
+TEST(StableEvaluationAtAPoint, PSLPDLMulti) {
+  std::shared_ptr<lf::mesh::Mesh> mesh_p = StableEvaluationAtAPoint::LoadMesh(
+      CURRENT_SOURCE_DIR "/../../meshes/square.msh");
+
+  const StableEvaluationAtAPoint::BoundaryQuadratureCache cache(mesh_p);
+
+  const auto u = [](Eigen::Vector2d x) -> double {
+    Eigen::Vector2d one(1.0, 0.0);
+    return std::log((x + one).norm());
+  };
+
+  // The batched evaluation applies no near-field refinement, so it is
+  // compared with the plain midpoint rule
+  Eigen::Matrix2Xd xs(2, 5);
+  xs << 0.3, 0.5, 0.3, 0.7, 0.6, 0.4, 0.5, 0.7, 0.3, 0.7;
+
+  double tol = 1.e-12;
+
+  for (unsigned int num_threads : {1u, 3u}) {
+    const Eigen::VectorXd psl =
+        StableEvaluationAtAPoint::PSLMulti(cache, u, xs, num_threads);
+    const Eigen::VectorXd pdl =
+        StableEvaluationAtAPoint::PDLMulti(cache, u, xs, num_threads);
+    for (Eigen::Index i = 0; i < xs.cols(); ++i) {
+      ASSERT_NEAR(psl[i], StableEvaluationAtAPoint::PSL(mesh_p, u, xs.col(i)),
+                  tol);
+      ASSERT_NEAR(pdl[i], StableEvaluationAtAPoint::PDL(mesh_p, u, xs.col(i)),
+                  tol);
+    }
+  }
+}
+
+TEST(StableEvaluationAtAPoint, BoundaryTreecode) {
+  std::shared_ptr<lf::mesh::Mesh> mesh_p = StableEvaluationAtAPoint::LoadMesh(
+      CURRENT_SOURCE_DIR "/../../meshes/square.msh");
+
+  const StableEvaluationAtAPoint::BoundaryQuadratureCache cache(mesh_p);
+
+  const auto u = [](Eigen::Vector2d x) -> double {
+    Eigen::Vector2d one(1.0, 0.0);
+    return std::log((x + one).norm());
+  };
+
+  // Points inside and outside of the square
+  Eigen::Matrix2Xd xs(2, 6);
+  xs << 0.3, 0.5, 0.1, 0.9, 2.0, -1.5, 0.4, 0.5, 0.8, 0.2, 3.0, 0.5;
+
+  double tol = 1.e-10;
+
+  const Eigen::VectorXd psl_direct =
+      StableEvaluationAtAPoint::PSLMulti(cache, u, xs);
+  const Eigen::VectorXd pdl_direct =
+      StableEvaluationAtAPoint::PDLMulti(cache, u, xs);
+  const Eigen::VectorXd psl_tree =
+      StableEvaluationAtAPoint::PSLMulti(cache, u, xs, 0, tol);
+  const Eigen::VectorXd pdl_tree =
+      StableEvaluationAtAPoint::PDLMulti(cache, u, xs, 0, tol);
+  for (Eigen::Index i = 0; i < xs.cols(); ++i) {
+    ASSERT_NEAR(psl_tree[i], psl_direct[i], tol);
+    ASSERT_NEAR(pdl_tree[i], pdl_direct[i], tol);
+  }
+}
+
+TEST(StableEvaluationAtAPoint, BoundaryTreecodeLeaves) {
+  // 256 quadrature points on the boundary, so the tree has many leaves and
+  // far boxes below the root are replaced by their expansions
+  std::shared_ptr<lf::mesh::Mesh> mesh_p =
+      StableEvaluationAtAPoint::GenerateUnitSquareMesh(32);
+  const StableEvaluationAtAPoint::BoundaryQuadratureCache cache(
+      mesh_p, lf::quad::make_QuadRule(lf::base::RefEl::kSegment(), 3));
+  ASSERT_GT(cache.NumPoints(), 8 * 16);
+
+  const auto u = [](Eigen::Vector2d x) -> double {
+    Eigen::Vector2d one(1.0, 0.0);
+    return std::log((x + one).norm());
+  };
+  Eigen::VectorXd v_vals(cache.NumPoints());
+  for (Eigen::Index l = 0; l < cache.NumPoints(); ++l) {
+    v_vals[l] = u(cache.Points().col(l));
+  }
+  // The accuracy is relative to the sum of the absolute weighted densities
+  const double scale = (v_vals.array() * cache.Weights().array()).abs().sum();
+
+  // Grid of points inside the square, and points near and outside of it
+  const int m = 20;
+  Eigen::Matrix2Xd xs(2, m * m + 4);
+  for (int i = 0; i < m; ++i) {
+    for (int j = 0; j < m; ++j) {
+      xs.col(i * m + j) << (i + 0.5) / m, (j + 0.5) / m;
+    }
+  }
+  xs.rightCols(4) << 0.37, 2.0, -1.5, 0.5, 1.e-3, 3.0, 0.5, 1.01;
+
+  const Eigen::VectorXd psl_direct =
+      StableEvaluationAtAPoint::PSLMultiValues(cache, v_vals, xs);
+  const Eigen::VectorXd pdl_direct =
+      StableEvaluationAtAPoint::PDLMultiValues(cache, v_vals, xs);
+  for (double tol : {1.e-6, 1.e-10}) {
+    const StableEvaluationAtAPoint::BoundaryTreecode tree(cache, tol);
+    const Eigen::VectorXd psl_tree = tree.SingleLayer(v_vals, xs);
+    const Eigen::VectorXd pdl_tree = tree.DoubleLayer(v_vals, xs);
+    for (Eigen::Index i = 0; i < xs.cols(); ++i) {
+      ASSERT_NEAR(psl_tree[i], psl_direct[i], tol * scale);
+      ASSERT_NEAR(pdl_tree[i], pdl_direct[i], tol * scale);
+    }
+  }
+}
+
+TEST(StableEvaluationAtAPoint, SolveBVPSolvers) {
+  std::shared_ptr<lf::mesh::Mesh> mesh_p = StableEvaluationAtAPoint::LoadMesh(
+      CURRENT_SOURCE_DIR "/../../meshes/square3.msh");
+
+  std::shared_ptr<lf::uscalfe::FeSpaceLagrangeO1<double>> fe_space =
+      std::make_shared<lf::uscalfe::FeSpaceLagrangeO1<double>>(mesh_p);
+
+  const auto u = [](Eigen::Vector2d x) -> double {
+    Eigen::Vector2d one(1.0, 0.0);
+    return std::log((x + one).norm());
+  };
+
+  const Eigen::VectorXd uFE_lu =
+      StableEvaluationAtAPoint::SolveBVP(fe_space, u);
+
+  double tol = 1.e-9;
+
+  for (StableEvaluationAtAPoint::SolverType type :
+       {StableEvaluationAtAPoint::SolverType::kSimplicialLDLT,
+        StableEvaluationAtAPoint::SolverType::kCGJacobi,
+        StableEvaluationAtAPoint::SolverType::kCGIncompleteCholesky,
+        StableEvaluationAtAPoint::SolverType::kCGAMG,
+        StableEvaluationAtAPoint::SolverType::kMultigrid}) {
+    StableEvaluationAtAPoint::SolverInfo info;
+    const Eigen::VectorXd uFE =
+        StableEvaluationAtAPoint::SolveBVP(fe_space, u, type, &info);
+    ASSERT_NEAR((uFE - uFE_lu).lpNorm<Eigen::Infinity>(), 0.0, tol);
+    ASSERT_LT(info.residual, tol);
+  }
+}
+
+TEST(StableEvaluationAtAPoint, SolveBVPReduced) {
+  const auto u = [](Eigen::Vector2d x) -> double {
+    Eigen::Vector2d one(1.0, 0.0);
+    return std::log((x + one).norm());
+  };
+
+  double tol = 1.e-9;
+
+  // square.msh has no interior dofs
+  for (const std::string name : {"square", "square3"}) {
+    auto fe_space = std::make_shared<lf::uscalfe::FeSpaceLagrangeO1<double>>(
+        StableEvaluationAtAPoint::LoadMesh(CURRENT_SOURCE_DIR
+                                           "/../../meshes/" +
+                                           name + ".msh"));
+
+    const Eigen::VectorXd uFE_ref =
+        StableEvaluationAtAPoint::SolveBVP(fe_space, u);
+    for (StableEvaluationAtAPoint::SolverType type :
+         {StableEvaluationAtAPoint::SolverType::kSparseLU,
+          StableEvaluationAtAPoint::SolverType::kSimplicialLDLT,
+          StableEvaluationAtAPoint::SolverType::kCGIncompleteCholesky}) {
+      const Eigen::VectorXd uFE =
+          StableEvaluationAtAPoint::SolveBVPReduced(fe_space, u, type);
+      ASSERT_EQ(uFE.size(), uFE_ref.size());
+      ASSERT_NEAR((uFE - uFE_ref).lpNorm<Eigen::Infinity>(), 0.0, tol);
+    }
+  }
+}
+
+TEST(StableEvaluationAtAPoint, SolveBVPSource) {
+  std::shared_ptr<lf::mesh::Mesh> mesh_p = StableEvaluationAtAPoint::LoadMesh(
+      CURRENT_SOURCE_DIR "/../../meshes/square7.msh");
+
+  std::shared_ptr<lf::uscalfe::FeSpaceLagrangeO1<double>> fe_space =
+      std::make_shared<lf::uscalfe::FeSpaceLagrangeO1<double>>(mesh_p);
+
+  const auto u = [](Eigen::Vector2d x) -> double {
+    Eigen::Vector2d one(1.0, 0.0);
+    return std::log((x + one).norm());
+  };
+
+  // Skipping the assembly for f = 0 does not change the result
+  const Eigen::VectorXd uFE = StableEvaluationAtAPoint::SolveBVP(fe_space, u);
+  const Eigen::VectorXd uFE_f0 = StableEvaluationAtAPoint::SolveBVP(
+      fe_space, u, StableEvaluationAtAPoint::SolverType::kSparseLU, nullptr,
+      [](Eigen::Vector2d /*x*/) -> double { return 0.0; });
+  ASSERT_NEAR((uFE - uFE_f0).lpNorm<Eigen::Infinity>(), 0.0, 1.e-12);
+
+  // -Laplace(u_q) = -4 for u_q = x^2 + y^2
+  const auto u_q = [](Eigen::Vector2d x) -> double { return x.squaredNorm(); };
+  const Eigen::VectorXd uFE_q = StableEvaluationAtAPoint::SolveBVP(
+      fe_space, u_q, StableEvaluationAtAPoint::SolverType::kSparseLU, nullptr,
+      [](Eigen::Vector2d /*x*/) -> double { return -4.0; });
+  lf::mesh::utils::MeshFunctionGlobal mf_q{u_q};
+  ASSERT_NEAR((uFE_q - lf::fe::NodalProjection(*fe_space, mf_q))
+                  .lpNorm<Eigen::Infinity>(),
+              0.0, 1.e-2);
+}
+
+TEST(StableEvaluationAtAPoint, AMGIterations) {
+  const auto u = [](Eigen::Vector2d x) -> double {
+    Eigen::Vector2d one(1.0, 0.0);
+    return std::log((x + one).norm());
+  };
+
+  // The number of CG iterations stays bounded under refinement
+  for (int k : {3, 5, 7}) {
+    auto fe_space = std::make_shared<lf::uscalfe::FeSpaceLagrangeO1<double>>(
+        StableEvaluationAtAPoint::LoadMesh(CURRENT_SOURCE_DIR
+                                           "/../../meshes/square" +
+                                           std::to_string(k) + ".msh"));
+    StableEvaluationAtAPoint::SolverInfo info;
+    StableEvaluationAtAPoint::SolveBVP(
+        fe_space, u, StableEvaluationAtAPoint::SolverType::kCGAMG, &info);
+    ASSERT_LE(info.iterations, 25u);
+    ASSERT_LT(info.residual, 1.e-10);
+  }
+}
+
+TEST(StableEvaluationAtAPoint, MeshCache) {
+  const std::string msh_file = CURRENT_SOURCE_DIR "/../../meshes/square3.msh";
+  std::shared_ptr<lf::mesh::Mesh> mesh_p =
+      StableEvaluationAtAPoint::LoadMesh(msh_file);
+  // Repeated loads are served from memory
+  ASSERT_EQ(StableEvaluationAtAPoint::LoadMesh(msh_file), mesh_p);
+
+  // The binary format reproduces all entities with their indices
+  const std::string bin_file =
+      (std::filesystem::temp_directory_path() / "square3_test.lfmb").string();
+  StableEvaluationAtAPoint::WriteBinaryMesh(*mesh_p, bin_file, 42);
+  std::uint64_t stamp = 0;
+  std::shared_ptr<lf::mesh::Mesh> mesh_bin =
+      StableEvaluationAtAPoint::ReadBinaryMesh(bin_file, &stamp);
+  ASSERT_NE(mesh_bin, nullptr);
+  ASSERT_EQ(stamp, 42u);
+  for (int codim = 0; codim <= 2; ++codim) {
+    ASSERT_EQ(mesh_bin->NumEntities(codim), mesh_p->NumEntities(codim));
+    for (const lf::mesh::Entity *e : mesh_p->Entities(codim)) {
+      const lf::mesh::Entity *e_bin =
+          mesh_bin->EntityByIndex(codim, mesh_p->Index(*e));
+      ASSERT_EQ(e_bin->RefEl(), e->RefEl());
+      ASSERT_NEAR((lf::geometry::Corners(*e_bin->Geometry()) -
+                   lf::geometry::Corners(*e->Geometry()))
+                      .norm(),
+                  0.0, 1.e-15);
+    }
+  }
+
+  // Invalid files are rejected, also if only a node index is out of range.
+  // The first edge follows the 40 byte header and the node coordinates.
+  ASSERT_EQ(StableEvaluationAtAPoint::ReadBinaryMesh(msh_file), nullptr);
+  {
+    std::fstream file(bin_file,
+                      std::ios::in | std::ios::out | std::ios::binary);
+    file.seekp(40 + 2 * sizeof(double) * mesh_p->NumEntities(2));
+    const std::uint32_t bad_index = mesh_p->NumEntities(2);
+    file.write(reinterpret_cast<const char *>(&bad_index), sizeof(bad_index));
+  }
+  ASSERT_EQ(StableEvaluationAtAPoint::ReadBinaryMesh(bin_file), nullptr);
+  std::filesystem::remove(bin_file);
+
+  // After clearing the memory cache the file is read again
+  StableEvaluationAtAPoint::ClearMeshCache();
+  ASSERT_NE(StableEvaluationAtAPoint::LoadMesh(msh_file), mesh_p);
+}
+
+TEST(StableEvaluationAtAPoint, UnitSquareMesh) {
+  const unsigned int n = 8;
+  StableEvaluationAtAPoint::UnitSquareBoundary boundary;
+  std::shared_ptr<lf::mesh::Mesh> mesh_p =
+      StableEvaluationAtAPoint::GenerateUnitSquareMesh(n, 0.2, 1, &boundary);
+  ASSERT_EQ(mesh_p->NumEntities(0), 2 * n * n);
+  ASSERT_EQ(mesh_p->NumEntities(2), (n + 1) * (n + 1));
+
+  // Perturbed cells are valid and cover the square
+  double area = 0.0;
+  for (const lf::mesh::Entity *cell : mesh_p->Entities(0)) {
+    const Eigen::MatrixXd corners = lf::geometry::Corners(*cell->Geometry());
+    const double det = (corners(0, 1) - corners(0, 0)) *
+                           (corners(1, 2) - corners(1, 0)) -
+                       (corners(1, 1) - corners(1, 0)) *
+                           (corners(0, 2) - corners(0, 0));
+    ASSERT_GT(det, 0.0);
+    area += lf::geometry::Volume(*cell->Geometry());
+  }
+  ASSERT_NEAR(area, 1.0, 1.e-12);
+
+  // The boundary metadata agrees with the boundary flags
+  auto bd_flags{lf::mesh::utils::flagEntitiesOnBoundary(mesh_p, 1)};
+  ASSERT_EQ(boundary.edges.size(), 4 * n);
+  ASSERT_EQ(boundary.normals.cols(), 4 * n);
+  std::vector<bool> is_listed(mesh_p->NumEntities(1), false);
+  for (std::size_t k = 0; k < boundary.edges.size(); ++k) {
+    const lf::mesh::Entity *edge = mesh_p->EntityByIndex(1, boundary.edges[k]);
+    ASSERT_TRUE(bd_flags(*edge));
+    is_listed[boundary.edges[k]] = true;
+    const Eigen::MatrixXd corners = lf::geometry::Corners(*edge->Geometry());
+    const Eigen::Vector2d midpoint = 0.5 * (corners.col(0) + corners.col(1));
+    ASSERT_NEAR((boundary.normals.col(k) -
+                 StableEvaluationAtAPoint::OuterNormalUnitSquare(midpoint))
+                    .norm(),
+                0.0, 1.e-15);
+  }
+  for (const lf::mesh::Entity *edge : mesh_p->Entities(1)) {
+    ASSERT_EQ(bool(bd_flags(*edge)), bool(is_listed[mesh_p->Index(*edge)]));
+  }
+
+  // Linear functions are reproduced exactly
+  std::shared_ptr<lf::uscalfe::FeSpaceLagrangeO1<double>> fe_space =
+      std::make_shared<lf::uscalfe::FeSpaceLagrangeO1<double>>(mesh_p);
+  const auto u = [](Eigen::Vector2d x) -> double {
+    return 1.0 + 2.0 * x[0] - x[1];
+  };
+  const Eigen::VectorXd uFE = StableEvaluationAtAPoint::SolveBVP(fe_space, u);
+  lf::mesh::utils::MeshFunctionGlobal mf_u{u};
+  ASSERT_NEAR((uFE - lf::fe::NodalProjection(*fe_space, mf_u))
+                  .lpNorm<Eigen::Infinity>(),
+              0.0, 1.e-10);
+}
+
+TEST(StableEvaluationAtAPoint, TriangleGeometryTable) {
+  std::shared_ptr<const lf::mesh::Mesh> mesh_p =
+      StableEvaluationAtAPoint::GenerateUnitSquareMesh(6, 0.2, 3);
+  const std::shared_ptr<const StableEvaluationAtAPoint::TriangleGeometryTable>
+      geometry = StableEvaluationAtAPoint::GetTriangleGeometryTable(mesh_p);
+  // Tables are shared per mesh
+  ASSERT_EQ(StableEvaluationAtAPoint::GetTriangleGeometryTable(mesh_p),
+            geometry);
+  ASSERT_EQ(geometry->NumCells(), mesh_p->NumEntities(0));
+
+  // The table agrees with the Geometry interface
+  Eigen::MatrixXd ref(2, 3);
+  ref << 1.0 / 3.0, 0.1, 0.7, 1.0 / 3.0, 0.6, 0.2;
+  for (const lf::mesh::Entity *cell : mesh_p->Entities(0)) {
+    const lf::base::glb_idx_t k = mesh_p->Index(*cell);
+    const lf::geometry::Geometry &geo{*cell->Geometry()};
+    ASSERT_NEAR((geometry->Corners(k) - lf::geometry::Corners(geo)).norm(),
+                0.0, 1.e-15);
+    ASSERT_NEAR(geometry->Volume(k), lf::geometry::Volume(geo), 1.e-15);
+    const Eigen::MatrixXd global = geo.Global(ref);
+    const Eigen::VectorXd gram_dets = geo.IntegrationElement(ref);
+    for (int l = 0; l < ref.cols(); ++l) {
+      ASSERT_NEAR((geometry->Global(k, ref.col(l)) - global.col(l)).norm(),
+                  0.0, 1.e-15);
+      ASSERT_NEAR((geometry->Local(k, global.col(l)) - ref.col(l)).norm(),
+                  0.0, 1.e-13);
+      ASSERT_NEAR(geometry->IntegrationElement(k), gram_dets[l], 1.e-15);
+    }
+  }
+
+  // The longest edge gives the mesh size
+  double max_length = 0.0;
+  for (const lf::mesh::Entity *edge : mesh_p->Entities(1)) {
+    max_length =
+        std::max(max_length, lf::geometry::Volume(*edge->Geometry()));
+  }
+  ASSERT_NEAR(StableEvaluationAtAPoint::MeshSize(mesh_p), max_length, 1.e-15);
+
+  // Tables of meshes that no longer exist are dropped on the next lookup
+  std::weak_ptr<const StableEvaluationAtAPoint::TriangleGeometryTable>
+      dead_table = StableEvaluationAtAPoint::GetTriangleGeometryTable(
+          StableEvaluationAtAPoint::GenerateUnitSquareMesh(4));
+  StableEvaluationAtAPoint::GetTriangleGeometryTable(mesh_p);
+  ASSERT_TRUE(dead_table.expired());
+
+  // MeshSize also works on meshes the table does not support
+  auto mesh_factory = std::make_unique<lf::mesh::hybrid2d::MeshFactory>(2);
+  Eigen::Matrix<double, 2, 4> quad_corners;
+  quad_corners << 0.0, 2.0, 2.0, 0.0, 0.0, 0.0, 1.0, 1.0;
+  for (int i = 0; i < 4; ++i) {
+    mesh_factory->AddPoint(quad_corners.col(i));
+  }
+  const std::array<lf::mesh::Mesh::size_type, 4> quad_nodes{0, 1, 2, 3};
+  mesh_factory->AddEntity(
+      lf::base::RefEl::kQuad(),
+      nonstd::span<const lf::mesh::Mesh::size_type>(quad_nodes.data(), 4),
+      std::make_unique<lf::geometry::QuadO1>(quad_corners));
+  std::shared_ptr<const lf::mesh::Mesh> quad_mesh_p = mesh_factory->Build();
+  ASSERT_FALSE(StableEvaluationAtAPoint::IsAffineTriangleMesh(*quad_mesh_p));
+  ASSERT_NEAR(StableEvaluationAtAPoint::MeshSize(quad_mesh_p), 2.0, 1.e-15);
+}
+
+TEST(StableEvaluationAtAPoint, Profiler) {
+  using StableEvaluationAtAPoint::Profiler;
+  using StableEvaluationAtAPoint::Stage;
+  std::shared_ptr<lf::mesh::Mesh> mesh_p = StableEvaluationAtAPoint::LoadMesh(
+      CURRENT_SOURCE_DIR "/../../meshes/square3.msh");
+  std::shared_ptr<lf::uscalfe::FeSpaceLagrangeO1<double>> fe_space =
+      std::make_shared<lf::uscalfe::FeSpaceLagrangeO1<double>>(mesh_p);
+  const auto u = [](Eigen::Vector2d x) -> double {
+    Eigen::Vector2d one(1.0, 0.0);
+    return std::log((x + one).norm());
+  };
+  const Eigen::Vector2d x(0.3, 0.4);
+
+  // Nothing is recorded while disabled
+  Profiler::Reset();
+  const Eigen::VectorXd uFE = StableEvaluationAtAPoint::SolveBVP(fe_space, u);
+  ASSERT_EQ(Profiler::Stats(Stage::kAssembly).calls, 0u);
+
+  Profiler::Enable();
+  const Eigen::VectorXd uFE_prof =
+      StableEvaluationAtAPoint::SolveBVP(fe_space, u);
+  StableEvaluationAtAPoint::StablePointEvaluation(fe_space, uFE_prof, x);
+  Profiler::Enable(false);
+  ASSERT_EQ((uFE_prof - uFE).norm(), 0.0);
+
+  const StableEvaluationAtAPoint::StageStats assembly =
+      Profiler::Stats(Stage::kAssembly);
+  ASSERT_EQ(assembly.calls, 1u);
+  ASSERT_EQ(assembly.cells, mesh_p->NumEntities(0));
+  ASSERT_GT(assembly.bytes, 0u);
+  ASSERT_GE(assembly.seconds, 0.0);
+  ASSERT_EQ(Profiler::Stats(Stage::kLinearSolve).calls, 1u);
+  const StableEvaluationAtAPoint::StageStats jstar =
+      Profiler::Stats(Stage::kJstar);
+  ASSERT_EQ(jstar.calls, 1u);
+  ASSERT_GT(jstar.cells, 0u);
+  ASSERT_LE(jstar.cells, mesh_p->NumEntities(0));
+  ASSERT_EQ(jstar.kernel_evaluations, 2 * jstar.cells);
+
+  Profiler::Reset();
+  ASSERT_EQ(Profiler::Stats(Stage::kJstar).calls, 0u);
+}
+
+TEST(StableEvaluationAtAPoint, StudyOptions) {
+  StableEvaluationAtAPoint::StudyOptions defaults;
+  defaults.meshes = {"square1.msh", "square2.msh"};
+  defaults.points = Eigen::Vector2d(0.3, 0.4);
+
+  // Generated meshes replace the default mesh files
+  const char *argv[] = {"main",      "--resolution", "8",       "--resolution",
+                        "16",        "--point",      "0.1,0.2", "--solver",
+                        "cg-amg",    "--threads",    "4",       "--no-plot"};
+  const StableEvaluationAtAPoint::StudyOptions options =
+      StableEvaluationAtAPoint::ParseStudyOptions(12, argv, defaults);
+  ASSERT_TRUE(options.meshes.empty());
+  ASSERT_EQ(options.resolutions, (std::vector<unsigned int>{8, 16}));
+  ASSERT_EQ(options.points.cols(), 1);
+  ASSERT_EQ(options.points(0, 0), 0.1);
+  ASSERT_EQ(options.points(1, 0), 0.2);
+  ASSERT_EQ(options.solver, StableEvaluationAtAPoint::SolverType::kCGAMG);
+  ASSERT_EQ(options.num_threads, 4u);
+  ASSERT_EQ(options.quad_order, defaults.quad_order);
+  ASSERT_FALSE(options.plot);
+
+  // Multigrid solver
+  const char *argv_mg[] = {"main", "--solver", "mg"};
+  ASSERT_EQ(StableEvaluationAtAPoint::ParseStudyOptions(3, argv_mg).solver,
+            StableEvaluationAtAPoint::SolverType::kMultigrid);
+
+  // Invalid arguments are rejected
+  const char *argv_bad[] = {"main", "--quad-order", "3x"};
+  ASSERT_THROW(StableEvaluationAtAPoint::ParseStudyOptions(3, argv_bad),
+               std::invalid_argument);
+  const char *argv_missing[] = {"main", "--threads"};
+  ASSERT_THROW(StableEvaluationAtAPoint::ParseStudyOptions(2, argv_missing),
+               std::invalid_argument);
+}
+
+TEST(StableEvaluationAtAPoint, CSRAssembler) {
+  std::shared_ptr<lf::mesh::Mesh> mesh_p = StableEvaluationAtAPoint::LoadMesh(
+      CURRENT_SOURCE_DIR "/../../meshes/square3.msh");
+
+  std::shared_ptr<lf::uscalfe::FeSpaceLagrangeO1<double>> fe_space =
+      std::make_shared<lf::uscalfe::FeSpaceLagrangeO1<double>>(mesh_p);
+  const lf::assemble::DofHandler &dofh{fe_space->LocGlobMap()};
+
+  const StableEvaluationAtAPoint::CSRAssembler assembler(dofh);
+
+  // Same Galerkin matrix as the assembly via COOMatrix
+  lf::uscalfe::LinearFELaplaceElementMatrix elmat_builder{};
+  lf::assemble::COOMatrix<double> A_coo(dofh.NumDofs(), dofh.NumDofs());
+  lf::assemble::AssembleMatrixLocally(0, dofh, dofh, elmat_builder, A_coo);
+  const Eigen::SparseMatrix<double> A_ref = A_coo.makeSparse();
+  const Eigen::SparseMatrix<double> A = assembler.Assemble(elmat_builder);
+  ASSERT_EQ(A.nonZeros(), assembler.Pattern().nonZeros());
+  ASSERT_NEAR(Eigen::MatrixXd(A - A_ref).lpNorm<Eigen::Infinity>(), 0.0,
+              1.e-12);
+
+  const auto u = [](Eigen::Vector2d x) -> double {
+    Eigen::Vector2d one(1.0, 0.0);
+    return std::log((x + one).norm());
+  };
+
+  // Same solution as SolveBVP(), also when the pattern is reused
+  const Eigen::VectorXd uFE_ref =
+      StableEvaluationAtAPoint::SolveBVP(fe_space, u);
+  for (int k = 0; k < 2; ++k) {
+    const Eigen::VectorXd uFE =
+        StableEvaluationAtAPoint::SolveBVP(fe_space, assembler, u);
+    ASSERT_NEAR((uFE - uFE_ref).lpNorm<Eigen::Infinity>(), 0.0, 1.e-10);
+  }
+
+  // Parallel assembly gives identical results
+  const StableEvaluationAtAPoint::CSRAssembler assembler_par(dofh, 4);
+  const Eigen::SparseMatrix<double> A_par =
+      assembler_par.Assemble(elmat_builder);
+  ASSERT_EQ(A_par.nonZeros(), A.nonZeros());
+  for (Eigen::Index k = 0; k < A.nonZeros(); ++k) {
+    ASSERT_EQ(A_par.valuePtr()[k], A.valuePtr()[k]);
+  }
+  const Eigen::VectorXd uFE =
+      StableEvaluationAtAPoint::SolveBVP(fe_space, assembler, u);
+  const Eigen::VectorXd uFE_par =
+      StableEvaluationAtAPoint::SolveBVP(fe_space, assembler_par, u);
+  for (Eigen::Index i = 0; i < uFE.size(); ++i) {
+    ASSERT_EQ(uFE_par[i], uFE[i]);
+  }
+}
+
+TEST(StableEvaluationAtAPoint, DirichletSolver) {
+  std::shared_ptr<lf::mesh::Mesh> mesh_p = StableEvaluationAtAPoint::LoadMesh(
+      CURRENT_SOURCE_DIR "/../../meshes/square3.msh");
+
+  std::shared_ptr<lf::uscalfe::FeSpaceLagrangeO1<double>> fe_space =
+      std::make_shared<lf::uscalfe::FeSpaceLagrangeO1<double>>(mesh_p);
+
+  const auto u = [](Eigen::Vector2d x) -> double {
+    Eigen::Vector2d one(1.0, 0.0);
+    return std::log((x + one).norm());
+  };
+  const auto u_lin = [](Eigen::Vector2d x) -> double {
+    return 1.0 + 2.0 * x[0] - x[1];
+  };
+
+  const StableEvaluationAtAPoint::DirichletSolver solver(fe_space);
+
+  double tol = 1.e-10;
+
+  // Same result as SolveBVP() for every data set
+  const Eigen::VectorXd uFE = solver.Solve(u);
+  const Eigen::VectorXd uFE_lin = solver.Solve(u_lin);
+  ASSERT_NEAR((uFE - StableEvaluationAtAPoint::SolveBVP(fe_space, u))
+                  .lpNorm<Eigen::Infinity>(),
+              0.0, tol);
+  ASSERT_NEAR((uFE_lin - StableEvaluationAtAPoint::SolveBVP(fe_space, u_lin))
+                  .lpNorm<Eigen::Infinity>(),
+              0.0, tol);
+
+  // Linear functions are reproduced exactly
+  lf::mesh::utils::MeshFunctionGlobal mf_lin{u_lin};
+  ASSERT_NEAR((uFE_lin - lf::fe::NodalProjection(*fe_space, mf_lin))
+                  .lpNorm<Eigen::Infinity>(),
+              0.0, tol);
+
+  // Block solve agrees with the single solves
+  Eigen::MatrixXd G(uFE.size(), 2);
+  G.col(0) = solver.BoundaryValues(u);
+  G.col(1) = solver.BoundaryValues(u_lin);
+  const Eigen::MatrixXd X = solver.SolveBoundaryValues(G);
+  ASSERT_NEAR((X.col(0) - uFE).lpNorm<Eigen::Infinity>(), 0.0, tol);
+  ASSERT_NEAR((X.col(1) - uFE_lin).lpNorm<Eigen::Infinity>(), 0.0, tol);
+}
+
+TEST(StableEvaluationAtAPoint, Multigrid) {
+  std::shared_ptr<lf::mesh::Mesh> mesh_p = StableEvaluationAtAPoint::LoadMesh(
+      CURRENT_SOURCE_DIR "/../../meshes/square3.msh");
+
+  const auto u = [](Eigen::Vector2d x) -> double {
+    Eigen::Vector2d one(1.0, 0.0);
+    return std::log((x + one).norm());
+  };
+
+  std::shared_ptr<lf::refinement::MeshHierarchy> mh =
+      lf::refinement::GenerateMeshHierarchyByUniformRefinemnt(mesh_p, 4);
+  const StableEvaluationAtAPoint::MultigridHierarchy mg(mh);
+  std::vector<StableEvaluationAtAPoint::SolverInfo> infos;
+  const std::vector<Eigen::VectorXd> uFE =
+      StableEvaluationAtAPoint::SolveBVPMultigrid(mg, u, 1.e-11, &infos);
+  ASSERT_EQ(uFE.size(), 5u);
+
+  double tol = 1.e-9;
+
+  for (unsigned int l = 0; l < mg.NumLevels(); ++l) {
+    const Eigen::VectorXd uFE_lu =
+        StableEvaluationAtAPoint::SolveBVP(mg.FeSpace(l), u);
+    ASSERT_NEAR((uFE[l] - uFE_lu).lpNorm<Eigen::Infinity>(), 0.0, tol);
+    ASSERT_LT(infos[l].residual, 1.e-11);
+    // Thanks to the warm start the number of V-cycles does not grow
+    ASSERT_LE(infos[l].iterations, 15u);
+  }
+
+  // The study with --solver mg evaluates the solutions of all levels, which
+  // the V-cycles compute up to the default residual 1e-10
+  double tol_eval = 1.e-6;
+  Eigen::Matrix2Xd xs(2, 2);
+  xs << 0.3, 0.5, 0.4, 0.6;
+  const auto evals = StableEvaluationAtAPoint::ComparePointEval(mg, u, xs);
+  ASSERT_EQ(evals.size(), 5u);
+  for (unsigned int l = 0; l < mg.NumLevels(); ++l) {
+    const auto [direct_eval, stable_eval] =
+        StableEvaluationAtAPoint::ComparePointEval(mg.FeSpace(l), u, xs);
+    ASSERT_NEAR((evals[l].first - direct_eval).lpNorm<Eigen::Infinity>(),
+                0.0, tol_eval);
+    ASSERT_NEAR((evals[l].second - stable_eval).lpNorm<Eigen::Infinity>(),
+                0.0, tol_eval);
+  }
+}
+
 /*
 TEST(StableEvaluationAtAPoint, stab_pointEval) {
-  auto mesh_factory_init = std::make_unique<lf::mesh::hybrid2d::MeshFactory>(2);
-  lf::io::GmshReader reader_init(std::move(mesh_factory_init),
-                                 CURRENT_SOURCE_DIR "/../../meshes/square.msh");
-  std::shared_ptr<lf::mesh::Mesh> mesh_p = reader_init.mesh();
+  std::shared_ptr<lf::mesh::Mesh> mesh_p = StableEvaluationAtAPoint::LoadMesh(
+      CURRENT_SOURCE_DIR "/../../meshes/square.msh");
 
   std::shared_ptr<lf::uscalfe::FeSpaceLagrangeO1<double>> fe_space =
       std::make_shared<lf::uscalfe::FeSpaceLagrangeO1<double>>(mesh_p);
@@ -0,0 +1,121 @@
+/**
+ * @file trianglegeometry.cc
+ * @brief NPDE homework StableEvaluationAtAPoint
+ * @author Amélie Loher, Erick Schulz & Philippe Peter
+ * @date 29.11.2021
+ * @copyright Developed at ETH Zurich
+ */
+
+#include "trianglegeometry.h"
+
+#include <lf/base/base.h>
+#include <lf/geometry/geometry.h>
+#include <lf/mesh/mesh.h>
+
+#include <Eigen/Core>
+#include <Eigen/LU>
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace StableEvaluationAtAPoint {
+
+TriangleGeometryTable::TriangleGeometryTable(
+    const std::shared_ptr<const lf::mesh::Mesh> &mesh_p) {
+  const lf::base::size_type N_nodes = mesh_p->NumEntities(2);
+  const lf::base::size_type N_cells = mesh_p->NumEntities(0);
+  vertices_.resize(2, N_nodes);
+  cell_nodes_.resize(3, N_cells);
+  jacobians_.resize(4, N_cells);
+  inv_jacobians_.resize(4, N_cells);
+  determinants_.resize(N_cells);
+
+  for (const lf::mesh::Entity *node : mesh_p->Entities(2)) {
+    vertices_.col(mesh_p->Index(*node)) =
+        lf::geometry::Corners(*node->Geometry()).col(0);
+  }
+  for (const lf::mesh::Entity *cell : mesh_p->Entities(0)) {
+    LF_VERIFY_MSG(lf::base::RefEl::kTria() == cell->RefEl() &&
+                      cell->Geometry()->isAffine(),
+                  "Only straight triangular cells are supported");
+    const lf::base::glb_idx_t k = mesh_p->Index(*cell);
+    int j = 0;
+    for (const lf::mesh::Entity *node : cell->SubEntities(2)) {
+      cell_nodes_(j++, k) = mesh_p->Index(*node);
+    }
+    const Eigen::Matrix<double, 2, 3> corners = Corners(k);
+    Eigen::Matrix2d J;
+    J << corners.col(1) - corners.col(0), corners.col(2) - corners.col(0);
+    const Eigen::Matrix2d J_inv = J.inverse();
+    jacobians_.col(k) = Eigen::Map<const Eigen::Vector4d>(J.data());
+    inv_jacobians_.col(k) = Eigen::Map<const Eigen::Vector4d>(J_inv.data());
+    determinants_[k] = std::abs(J.determinant());
+  }
+}
+
+double TriangleGeometryTable::MaxEdgeLength() const {
+  // Every edge of a 2D mesh belongs to a cell, whose edge vectors are the
+  // columns of J_k and their difference
+  double max_length2 = 0.0;
+  for (Eigen::Index k = 0; k < NumCells(); ++k) {
+    const auto J = Jacobian(k);
+    max_length2 = std::max({max_length2, J.col(0).squaredNorm(),
+                            J.col(1).squaredNorm(),
+                            (J.col(1) - J.col(0)).squaredNorm()});
+  }
+  return std::sqrt(max_length2);
+}
+
+bool IsAffineTriangleMesh(const lf::mesh::Mesh &mesh) {
+  for (const lf::mesh::Entity *cell : mesh.Entities(0)) {
+    if (lf::base::RefEl::kTria() != cell->RefEl() ||
+        !cell->Geometry()->isAffine()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+namespace {
+
+struct TableEntry {
+  std::weak_ptr<const lf::mesh::Mesh> mesh;
+  std::shared_ptr<const TriangleGeometryTable> table;
+};
+std::mutex table_mutex;
+std::map<const lf::mesh::Mesh *, TableEntry> table_cache;
+
+// Drops the tables of meshes that no longer exist, table_mutex must be held
+void EvictExpiredTables() {
+  for (auto it = table_cache.begin(); it != table_cache.end();) {
+    it = it->second.mesh.expired() ? table_cache.erase(it) : std::next(it);
+  }
+}
+
+}  // namespace
+
+std::shared_ptr<const TriangleGeometryTable> GetTriangleGeometryTable(
+    const std::shared_ptr<const lf::mesh::Mesh> &mesh_p) {
+  {
+    std::lock_guard<std::mutex> lock(table_mutex);
+    EvictExpiredTables();
+    auto it = table_cache.find(mesh_p.get());
+    // The address may have been reused by a new mesh after the old one died
+    if (it != table_cache.end() && it->second.mesh.lock() == mesh_p) {
+      return it->second.table;
+    }
+  }
+
+  // Building happens without the lock, so that tables of different meshes
+  // can be built concurrently
+  auto table = std::make_shared<const TriangleGeometryTable>(mesh_p);
+  std::lock_guard<std::mutex> lock(table_mutex);
+  EvictExpiredTables();
+  table_cache[mesh_p.get()] = {mesh_p, table};
+  return table;
+}
+
+}  // namespace StableEvaluationAtAPoint
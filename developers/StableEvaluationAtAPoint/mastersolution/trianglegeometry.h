@@ -0,0 +1,101 @@
+#ifndef TRIANGLE_GEOMETRY_H
+#define TRIANGLE_GEOMETRY_H
+
+/**
+ * @file trianglegeometry.h
+ * @brief NPDE homework StableEvaluationAtAPoint
+ * @author Amélie Loher, Erick Schulz & Philippe Peter
+ * @date 29.11.2021
+ * @copyright Developed at ETH Zurich
+ */
+
+#include <lf/base/base.h>
+#include <lf/mesh/mesh.h>
+
+#include <Eigen/Core>
+#include <memory>
+
+namespace StableEvaluationAtAPoint {
+
+/** @brief Precomputed geometry of a mesh of straight triangles
+ *
+ * Cell k is the image of the reference triangle under the affine map
+ * x = a_0 + J_k * loc, where a_0 is its first corner and the columns of J_k
+ * are the edge vectors a_1 - a_0 and a_2 - a_0. The node coordinates, the
+ * node indices of the cells, J_k, J_k^{-1} and |det J_k| are computed once
+ * and stored in contiguous arrays indexed by the cell index. The accessors
+ * below replace the Geometry interface of LehrFEM++ in loops over cells:
+ * they are inline, involve no virtual calls and return fixed-size Eigen
+ * types, so they never allocate.
+ */
+class TriangleGeometryTable {
+ public:
+  /** @brief Extracts the geometry of all cells
+   * @param mesh_p mesh consisting of triangles with affine geometry only
+   */
+  explicit TriangleGeometryTable(
+      const std::shared_ptr<const lf::mesh::Mesh> &mesh_p);
+
+  Eigen::Index NumCells() const { return determinants_.size(); }
+  /** @brief Coordinates of the nodes, column i belongs to node index i */
+  const Eigen::Matrix2Xd &Vertices() const { return vertices_; }
+  /** @brief Index of the j-th node of cell k */
+  lf::base::size_type Node(Eigen::Index k, int j) const {
+    return cell_nodes_(j, k);
+  }
+
+  /** @brief Corners of cell k in the order of its nodes */
+  Eigen::Matrix<double, 2, 3> Corners(Eigen::Index k) const {
+    Eigen::Matrix<double, 2, 3> corners;
+    corners << vertices_.col(cell_nodes_(0, k)),
+        vertices_.col(cell_nodes_(1, k)), vertices_.col(cell_nodes_(2, k));
+    return corners;
+  }
+  Eigen::Map<const Eigen::Matrix2d> Jacobian(Eigen::Index k) const {
+    return Eigen::Map<const Eigen::Matrix2d>(jacobians_.col(k).data());
+  }
+  Eigen::Map<const Eigen::Matrix2d> InverseJacobian(Eigen::Index k) const {
+    return Eigen::Map<const Eigen::Matrix2d>(inv_jacobians_.col(k).data());
+  }
+  /** @brief |det J_k|, the constant Gramian determinant of cell k */
+  double IntegrationElement(Eigen::Index k) const { return determinants_[k]; }
+  /** @brief Area of cell k */
+  double Volume(Eigen::Index k) const { return 0.5 * determinants_[k]; }
+
+  /** @brief Maps the point loc of the reference triangle to cell k */
+  Eigen::Vector2d Global(Eigen::Index k, const Eigen::Vector2d &loc) const {
+    return vertices_.col(cell_nodes_(0, k)) + Jacobian(k) * loc;
+  }
+  /** @brief Local coordinates of the point global with respect to cell k */
+  Eigen::Vector2d Local(Eigen::Index k, const Eigen::Vector2d &global) const {
+    return InverseJacobian(k) * (global - vertices_.col(cell_nodes_(0, k)));
+  }
+
+  /** @brief Length of the longest edge of the mesh */
+  double MaxEdgeLength() const;
+
+ private:
+  Eigen::Matrix2Xd vertices_;
+  Eigen::Matrix<lf::base::size_type, 3, Eigen::Dynamic> cell_nodes_;
+  // J_k and J_k^{-1} stored column-major in column k
+  Eigen::Matrix<double, 4, Eigen::Dynamic> jacobians_;
+  Eigen::Matrix<double, 4, Eigen::Dynamic> inv_jacobians_;
+  Eigen::VectorXd determinants_;
+};
+
+/** @brief Checks whether all cells of a mesh are triangles with affine
+ * geometry, as required by TriangleGeometryTable */
+bool IsAffineTriangleMesh(const lf::mesh::Mesh &mesh);
+
+/** @brief Returns the geometry table of a mesh, building it on first use
+ *
+ * Tables are kept in memory while their mesh is alive, so all functions
+ * working on the same mesh share one table. Every call drops the tables of
+ * meshes that no longer exist. Safe to call from several threads.
+ */
+std::shared_ptr<const TriangleGeometryTable> GetTriangleGeometryTable(
+    const std::shared_ptr<const lf::mesh::Mesh> &mesh_p);
+
+}  // namespace StableEvaluationAtAPoint
+
+#endif  // TRIANGLE_GEOMETRY_H
@@ -0,0 +1,118 @@
+/**
+ * @file unitsquaremesh.cc
+ * @brief NPDE homework StableEvaluationAtAPoint
+ * @author Amélie Loher, Erick Schulz & Philippe Peter
+ * @date 29.11.2021
+ * @copyright Developed at ETH Zurich
+ */
+
+#include "unitsquaremesh.h"
+
+#include <lf/base/base.h>
+#include <lf/geometry/geometry.h>
+#include <lf/mesh/hybrid2d/hybrid2d.h>
+
+#include <Eigen/Core>
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "profiler.h"
+
+namespace StableEvaluationAtAPoint {
+
+std::shared_ptr<lf::mesh::Mesh> GenerateUnitSquareMesh(
+    unsigned int n, double perturbation, unsigned int seed,
+    UnitSquareBoundary *boundary) {
+  using size_type = lf::mesh::Mesh::size_type;
+  ScopedTimer timer(Stage::kMeshLoading);
+  LF_VERIFY_MSG(n > 0, "At least one square per direction required");
+  LF_VERIFY_MSG(perturbation >= 0.0 && perturbation < 0.25,
+                "Perturbation must lie in [0, 0.25)");
+  const double h = 1.0 / n;
+  auto node = [n](unsigned int i, unsigned int j) -> size_type {
+    return j * (n + 1) + i;
+  };
+
+  // Nodes, row by row
+  Eigen::Matrix2Xd coords(2, (n + 1) * (n + 1));
+  std::mt19937 gen(seed);
+  std::uniform_real_distribution<double> offset(-perturbation * h,
+                                                perturbation * h);
+  for (unsigned int j = 0; j <= n; ++j) {
+    for (unsigned int i = 0; i <= n; ++i) {
+      Eigen::Vector2d x(i * h, j * h);
+      if (i == n) {
+        x[0] = 1.0;
+      }
+      if (j == n) {
+        x[1] = 1.0;
+      }
+      if (perturbation > 0.0 && i > 0 && i < n && j > 0 && j < n) {
+        x[0] += offset(gen);
+        x[1] += offset(gen);
+      }
+      coords.col(node(i, j)) = x;
+    }
+  }
+  auto mesh_factory = std::make_unique<lf::mesh::hybrid2d::MeshFactory>(2);
+  for (Eigen::Index k = 0; k < coords.cols(); ++k) {
+    mesh_factory->AddPoint(coords.col(k));
+  }
+
+  // Boundary edges are added first, so their indices are known
+  const std::array<Eigen::Vector2d, 4> normals{
+      Eigen::Vector2d(0.0, -1.0), Eigen::Vector2d(1.0, 0.0),
+      Eigen::Vector2d(0.0, 1.0), Eigen::Vector2d(-1.0, 0.0)};
+  if (boundary != nullptr) {
+    boundary->edges.clear();
+    boundary->normals.resize(2, 4 * n);
+  }
+  auto add_edge = [&](size_type a, size_type b, int side) {
+    const std::array<size_type, 2> nodes{a, b};
+    Eigen::Matrix2d corners;
+    corners << coords.col(a), coords.col(b);
+    const size_type index = mesh_factory->AddEntity(
+        lf::base::RefEl::kSegment(),
+        nonstd::span<const size_type>(nodes.data(), 2),
+        std::make_unique<lf::geometry::SegmentO1>(corners));
+    if (boundary != nullptr) {
+      boundary->normals.col(boundary->edges.size()) = normals[side];
+      boundary->edges.push_back(index);
+    }
+  };
+  for (unsigned int i = 0; i < n; ++i) {
+    add_edge(node(i, 0), node(i + 1, 0), 0);
+  }
+  for (unsigned int j = 0; j < n; ++j) {
+    add_edge(node(n, j), node(n, j + 1), 1);
+  }
+  for (unsigned int i = n; i > 0; --i) {
+    add_edge(node(i, n), node(i - 1, n), 2);
+  }
+  for (unsigned int j = n; j > 0; --j) {
+    add_edge(node(0, j), node(0, j - 1), 3);
+  }
+
+  // Two counterclockwise triangles per square
+  auto add_triangle = [&](size_type a, size_type b, size_type c) {
+    const std::array<size_type, 3> nodes{a, b, c};
+    Eigen::Matrix<double, 2, 3> corners;
+    corners << coords.col(a), coords.col(b), coords.col(c);
+    mesh_factory->AddEntity(lf::base::RefEl::kTria(),
+                            nonstd::span<const size_type>(nodes.data(), 3),
+                            std::make_unique<lf::geometry::TriaO1>(corners));
+  };
+  for (unsigned int j = 0; j < n; ++j) {
+    for (unsigned int i = 0; i < n; ++i) {
+      add_triangle(node(i, j), node(i + 1, j), node(i + 1, j + 1));
+      add_triangle(node(i, j), node(i + 1, j + 1), node(i, j + 1));
+    }
+  }
+  Profiler::CountCells(Stage::kMeshLoading, 2 * std::size_t(n) * n);
+  return mesh_factory->Build();
+}
+
+}  // namespace StableEvaluationAtAPoint
@@ -0,0 +1,45 @@
+#ifndef UNIT_SQUARE_MESH_H
+#define UNIT_SQUARE_MESH_H
+
+/**
+ * @file unitsquaremesh.h
+ * @brief NPDE homework StableEvaluationAtAPoint
+ * @author Amélie Loher, Erick Schulz & Philippe Peter
+ * @date 29.11.2021
+ * @copyright Developed at ETH Zurich
+ */
+
+#include <lf/mesh/mesh.h>
+
+#include <Eigen/Core>
+#include <memory>
+#include <vector>
+
+namespace StableEvaluationAtAPoint {
+
+/** @brief Boundary edges of a mesh of the unit square */
+struct UnitSquareBoundary {
+  // Indices of the boundary edges, counterclockwise starting at (0,0)
+  std::vector<lf::mesh::Mesh::size_type> edges;
+  // Outer unit normal of every boundary edge
+  Eigen::Matrix2Xd normals;
+};
+
+/** @brief Generates a triangulation of the unit square
+ *
+ * The square is divided into n x n squares of width h = 1/n, each split
+ * into two triangles by the diagonal from its lower left to its upper right
+ * corner. If perturbation > 0, every interior node is moved by a random
+ * offset of at most perturbation * h in each coordinate, which keeps all
+ * triangles valid for perturbation < 0.25. Nodes are numbered row by row.
+ * @param seed seed of the random perturbation
+ * @param boundary if not nullptr, receives the boundary edges and their
+ * normals, so that they need not be searched for
+ */
+std::shared_ptr<lf::mesh::Mesh> GenerateUnitSquareMesh(
+    unsigned int n, double perturbation = 0.0, unsigned int seed = 0,
+    UnitSquareBoundary *boundary = nullptr);
+
+}  // namespace StableEvaluationAtAPoint
+
+#endif  // UNIT_SQUARE_MESH_H